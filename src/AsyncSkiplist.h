@@ -0,0 +1,1232 @@
+#ifndef ASYNC_SKIPLIST_H
+#define ASYNC_SKIPLIST_H
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define SKIPLIST_HAS_IO_URING 1
+#else
+#define SKIPLIST_HAS_IO_URING 0
+#endif
+
+#include "Skiplist.h"
+
+/*
+* 基于 C++20 协程的异步接口（需要 -std=c++20）
+*
+* AsyncSkiplist 包装一个已有的 Skiplist，提供 async_put / async_get / async_scan / async_snapshot，
+* 每个操作都是惰性的 AsyncTask，被 co_await 时切换到 SkiplistExecutor 的线程上执行，
+* 调用方所在的事件循环线程不会阻塞在 rw_mtx 或文件读写上。
+* 操作完成后调用方在执行器线程上继续运行，需要回到自己的事件循环时由调用方自行调度。
+*
+* 持久化 I/O 由 AsyncFileIO 完成：优先使用 io_uring（直接系统调用，不依赖 liburing），
+* 写入使用预先注册的固定缓冲区（IORING_OP_WRITE_FIXED）；内核不支持或无权限时退回到独立的 I/O 线程池。
+*/
+
+#define ASYNC_RING_ENTRIES 64                 // io_uring 提交队列长度
+#define ASYNC_IO_BUFFERS 8                    // 注册缓冲区个数
+#define ASYNC_IO_BUFFER_SIZE (256 * 1024)     // 每个注册缓冲区的大小
+#define ASYNC_IO_THREADS 2                    // 退回线程池时的 I/O 线程数
+#define ASYNC_LOG_MAGIC 0x524c4157u           // 日志记录头部标记 "WALR"
+#define ASYNC_LOG_HEADER 12                   // [u32 标记][u32 负载长度][u32 校验和]
+#define ASYNC_LOG_PREFIX 9                    // 负载开头的 [u8 类型][i64 过期时刻]
+
+
+// 日志记录类型
+enum AsyncLogOp : unsigned char {
+    LOG_INSERT = 1,   // key 不存在时插入，带插入时的绝对过期时刻，0 表示不过期
+    LOG_EDIT,         // key 已存在时只更新值，过期时刻不变
+    LOG_DELETE,       // 删除 key，负载中没有值
+};
+
+
+/*
+* 固定线程数的执行器，协程通过 co_await executor.schedule() 切换到执行器线程
+*/
+class SkiplistExecutor {
+
+public:
+
+    explicit SkiplistExecutor(int);
+    ~SkiplistExecutor();
+
+    void post(std::function<void()>);
+    void post(std::coroutine_handle<>);
+    int thread_count() const;
+
+    struct ScheduleAwaiter {
+        SkiplistExecutor *executor;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) { executor -> post(h); }
+        void await_resume() const noexcept {}
+    };
+    ScheduleAwaiter schedule() { return ScheduleAwaiter{this}; }
+
+private:
+
+    void run();
+
+    std::vector<std::thread> _workers;
+    std::deque<std::function<void()>> _tasks;
+    std::mutex _mtx;
+    std::condition_variable _cv;
+    bool _stop{false};
+
+};
+
+
+inline SkiplistExecutor::SkiplistExecutor(int threads) {
+    threads = threads > 0 ? threads : 1;
+    for (int i = 0; i < threads; ++ i) {
+        _workers.emplace_back(&SkiplistExecutor::run, this);
+    }
+}
+
+
+// 退出前执行完队列中剩余的任务
+inline SkiplistExecutor::~SkiplistExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        _stop = true;
+    }
+    _cv.notify_all();
+    for (std::thread &t : _workers) {
+        t.join();
+    }
+}
+
+
+inline void SkiplistExecutor::post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        _tasks.push_back(std::move(task));
+    }
+    _cv.notify_one();
+}
+
+
+inline void SkiplistExecutor::post(std::coroutine_handle<> h) {
+    post([h]() { h.resume(); });
+}
+
+
+inline int SkiplistExecutor::thread_count() const {
+    return (int)_workers.size();
+}
+
+
+inline void SkiplistExecutor::run() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(_mtx);
+            _cv.wait(lock, [this]() { return _stop || !_tasks.empty(); });
+            if (_tasks.empty()) {
+                return ;
+            }
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+        task();
+    }
+}
+
+
+
+/*
+* 惰性协程任务：创建时不执行，被 co_await 时才开始，结束后通过对称转移恢复等待者
+*/
+template<typename T> class AsyncTask;
+
+struct AsyncPromiseBase {
+
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+        template<typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+            std::coroutine_handle<> next = h.promise().continuation;
+            return next ? next : std::noop_coroutine();
+        }
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() { error = std::current_exception(); }
+};
+
+
+template<typename T>
+struct AsyncPromise : AsyncPromiseBase {
+
+    std::optional<T> value;
+
+    AsyncTask<T> get_return_object();
+    template<typename U> void return_value(U &&v) { value.emplace(std::forward<U>(v)); }
+    T result() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return std::move(*value);
+    }
+};
+
+
+template<>
+struct AsyncPromise<void> : AsyncPromiseBase {
+
+    AsyncTask<void> get_return_object();
+    void return_void() const noexcept {}
+    void result() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+
+template<typename T>
+class AsyncTask {
+
+public:
+
+    using promise_type = AsyncPromise<T>;
+
+    explicit AsyncTask(std::coroutine_handle<promise_type> h) : _handle(h) {}
+    AsyncTask(AsyncTask &&other) noexcept : _handle(std::exchange(other._handle, nullptr)) {}
+    AsyncTask(const AsyncTask&) = delete;
+    AsyncTask &operator=(const AsyncTask&) = delete;
+    ~AsyncTask() {
+        if (_handle) {
+            _handle.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+        _handle.promise().continuation = caller;
+        return _handle;
+    }
+    T await_resume() { return _handle.promise().result(); }
+
+private:
+
+    std::coroutine_handle<promise_type> _handle;
+
+};
+
+
+template<typename T>
+AsyncTask<T> AsyncPromise<T>::get_return_object() {
+    return AsyncTask<T>(std::coroutine_handle<AsyncPromise<T>>::from_promise(*this));
+}
+
+
+inline AsyncTask<void> AsyncPromise<void>::get_return_object() {
+    return AsyncTask<void>(std::coroutine_handle<AsyncPromise<void>>::from_promise(*this));
+}
+
+
+
+/*
+* 在普通线程中阻塞等待一个 AsyncTask 完成，用于测试或程序入口，不要在事件循环线程中调用
+*/
+struct SyncWaitTask {
+
+    struct promise_type {
+
+        std::mutex mtx;
+        std::condition_variable cv;
+        bool done{false};
+        std::exception_ptr error;
+
+        // 在协程挂起之后再通知，等待方随后可以安全地销毁协程帧
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<promise_type> h) const noexcept {
+                promise_type &p = h.promise();
+                std::lock_guard<std::mutex> lock(p.mtx);
+                p.done = true;
+                p.cv.notify_all();
+            }
+            void await_resume() const noexcept {}
+        };
+
+        SyncWaitTask get_return_object() {
+            return SyncWaitTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        FinalAwaiter final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+
+template<typename T>
+SyncWaitTask sync_wait_impl(AsyncTask<T> &task, std::optional<T> *out) {
+    out -> emplace(co_await task);
+}
+
+
+inline SyncWaitTask sync_wait_impl(AsyncTask<void> &task) {
+    co_await task;
+}
+
+
+template<typename T>
+T sync_wait(AsyncTask<T> task) {
+
+    std::optional<std::conditional_t<std::is_void_v<T>, char, T>> out;
+    SyncWaitTask waiter;
+    if constexpr (std::is_void_v<T>) {
+        waiter = sync_wait_impl(task);
+    } else {
+        waiter = sync_wait_impl(task, &out);
+    }
+
+    auto &p = waiter.handle.promise();
+    waiter.handle.resume();
+    {
+        std::unique_lock<std::mutex> lock(p.mtx);
+        p.cv.wait(lock, [&p]() { return p.done; });
+    }
+    std::exception_ptr error = p.error;
+    waiter.handle.destroy();
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    if constexpr (!std::is_void_v<T>) {
+        return std::move(*out);
+    }
+}
+
+
+
+/*
+* 一组一起提交、一起等待的文件 I/O 请求
+* co_await 返回所有写入的总字节数，任一请求失败时返回 -errno
+*/
+class AsyncFileIO;
+
+struct IoOp {
+    int opcode;         // IoBatch::OP_WRITE / OP_FSYNC
+    int fd;
+    const char *data;
+    unsigned len;
+    off_t offset;
+    int buf_index;      // 注册缓冲区下标，-1 表示普通内存
+    int result{0};
+    class IoBatch *batch{nullptr};
+};
+
+
+class IoBatch {
+
+    friend class AsyncFileIO;
+
+public:
+
+    enum { OP_WRITE = 1, OP_FSYNC };
+
+    explicit IoBatch(AsyncFileIO &io) : _io(&io) {}
+
+    void write(int, const char*, unsigned, off_t, int);
+    // 在此前提交的所有写入完成之后执行 fdatasync
+    void fsync(int);
+    int size() const { return (int)_ops.size(); }
+
+    bool await_ready() const noexcept { return _ops.empty(); }
+    void await_suspend(std::coroutine_handle<>);
+    long await_resume() const;
+
+private:
+
+    AsyncFileIO *_io;
+    std::vector<IoOp> _ops;
+    std::atomic<int> _pending{0};
+    std::coroutine_handle<> _handle;
+
+};
+
+
+
+/*
+* 持久化 I/O：io_uring 提交，独立线程收割完成事件并把等待的协程交回执行器；
+* io_uring 不可用时由 I/O 线程池执行 pwrite / fdatasync
+*/
+class AsyncFileIO {
+
+    friend class IoBatch;
+
+public:
+
+    explicit AsyncFileIO(SkiplistExecutor&);
+    ~AsyncFileIO();
+
+    bool using_io_uring() const;
+    bool buffers_registered() const;
+
+    // 等待一个空闲的注册缓冲区，co_await 返回缓冲区下标
+    struct BufferAwaiter {
+        AsyncFileIO *io;
+        int index{-1};
+        std::coroutine_handle<> handle;
+        bool await_ready() { index = io -> try_acquire_buffer(); return index >= 0; }
+        bool await_suspend(std::coroutine_handle<>);
+        int await_resume() const noexcept { return index; }
+    };
+    BufferAwaiter acquire_buffer() { return BufferAwaiter{this, -1, nullptr}; }
+    int try_acquire_buffer();
+    void release_buffer(int);
+    char *buffer(int index) { return _buffers[index]; }
+
+private:
+
+    bool setup_ring();
+    void close_ring();
+    void submit(IoBatch*);
+    int flush_sq(unsigned);
+    void submit_fallback(IoBatch*);
+    void reap();
+    void complete(IoOp*, int);
+
+    SkiplistExecutor &_executor;
+
+    std::vector<char*> _buffers;
+    std::vector<int> _free_buffers;
+    std::deque<BufferAwaiter*> _buffer_waiters;
+    std::mutex _buffer_mtx;
+    bool _registered{false};
+
+    bool _uring{false};
+#if SKIPLIST_HAS_IO_URING
+    int _ring_fd{-1};
+    void *_sq_ptr{nullptr};
+    void *_cq_ptr{nullptr};
+    size_t _sq_size{0};
+    size_t _cq_size{0};
+    io_uring_sqe *_sqes{nullptr};
+    size_t _sqes_size{0};
+    unsigned *_sq_head{nullptr};
+    unsigned *_sq_tail{nullptr};
+    unsigned *_sq_mask{nullptr};
+    unsigned *_sq_array{nullptr};
+    unsigned _sq_entries{0};
+    unsigned *_cq_head{nullptr};
+    unsigned *_cq_tail{nullptr};
+    unsigned *_cq_mask{nullptr};
+    io_uring_cqe *_cqes{nullptr};
+    std::mutex _sq_mtx;
+    std::thread _reaper;
+#endif
+
+    std::unique_ptr<SkiplistExecutor> _fallback;
+
+};
+
+
+inline void IoBatch::write(int fd, const char *data, unsigned len, off_t offset, int buf_index) {
+    _ops.push_back(IoOp{OP_WRITE, fd, data, len, offset, buf_index});
+}
+
+
+inline void IoBatch::fsync(int fd) {
+    _ops.push_back(IoOp{OP_FSYNC, fd, nullptr, 0, 0, -1});
+}
+
+
+// 提交之后不能再访问 this：完成事件可能已经在其他线程上恢复了协程
+inline void IoBatch::await_suspend(std::coroutine_handle<> h) {
+    _handle = h;
+    _pending.store((int)_ops.size(), std::memory_order_relaxed);
+    for (IoOp &op : _ops) {
+        op.batch = this;
+    }
+    if (_io -> _uring) {
+        _io -> submit(this);
+    } else {
+        _io -> submit_fallback(this);
+    }
+}
+
+
+inline long IoBatch::await_resume() const {
+    long total = 0;
+    for (const IoOp &op : _ops) {
+        if (op.result < 0) {
+            return op.result;
+        }
+        if (op.opcode == OP_WRITE) {
+            if ((unsigned)op.result != op.len) {
+                return -EIO;
+            }
+            total += op.result;
+        }
+    }
+    return total;
+}
+
+
+inline AsyncFileIO::AsyncFileIO(SkiplistExecutor &executor) : _executor(executor) {
+
+    for (int i = 0; i < ASYNC_IO_BUFFERS; ++ i) {
+        _buffers.push_back((char*)aligned_alloc(4096, ASYNC_IO_BUFFER_SIZE));
+        _free_buffers.push_back(i);
+    }
+
+    _uring = setup_ring();
+    if (!_uring) {
+        _fallback.reset(new SkiplistExecutor(ASYNC_IO_THREADS));
+    }
+}
+
+
+inline AsyncFileIO::~AsyncFileIO() {
+    close_ring();
+    _fallback.reset();
+    for (char *buf : _buffers) {
+        free(buf);
+    }
+}
+
+
+inline bool AsyncFileIO::using_io_uring() const {
+    return _uring;
+}
+
+
+inline bool AsyncFileIO::buffers_registered() const {
+    return _registered;
+}
+
+
+inline int AsyncFileIO::try_acquire_buffer() {
+    std::lock_guard<std::mutex> lock(_buffer_mtx);
+    if (_free_buffers.empty()) {
+        return -1;
+    }
+    int index = _free_buffers.back();
+    _free_buffers.pop_back();
+    return index;
+}
+
+
+inline bool AsyncFileIO::BufferAwaiter::await_suspend(std::coroutine_handle<> h) {
+    std::lock_guard<std::mutex> lock(io -> _buffer_mtx);
+    if (!io -> _free_buffers.empty()) {
+        index = io -> _free_buffers.back();
+        io -> _free_buffers.pop_back();
+        return false;
+    }
+    handle = h;
+    io -> _buffer_waiters.push_back(this);
+    return true;
+}
+
+
+// 有协程在等待时直接把缓冲区交给它
+inline void AsyncFileIO::release_buffer(int index) {
+    BufferAwaiter *waiter = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_buffer_mtx);
+        if (_buffer_waiters.empty()) {
+            _free_buffers.push_back(index);
+            return ;
+        }
+        waiter = _buffer_waiters.front();
+        _buffer_waiters.pop_front();
+        waiter -> index = index;
+    }
+    _executor.post(waiter -> handle);
+}
+
+
+inline void AsyncFileIO::complete(IoOp *op, int res) {
+    op -> result = res;
+    IoBatch *batch = op -> batch;
+    if (batch -> _pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        _executor.post(batch -> _handle);
+    }
+}
+
+
+// 同一批请求在一个线程中顺序执行，fsync 自然排在写入之后
+inline void AsyncFileIO::submit_fallback(IoBatch *batch) {
+    _fallback -> post([this, batch]() {
+        size_t n = batch -> _ops.size();
+        for (size_t i = 0; i < n; ++ i) {
+            IoOp &op = batch -> _ops[i];
+            int res;
+            if (op.opcode == IoBatch::OP_WRITE) {
+                res = (int)pwrite(op.fd, op.data, op.len, op.offset);
+            } else {
+                res = fdatasync(op.fd);
+            }
+            complete(&op, res < 0 ? -errno : res);
+        }
+    });
+}
+
+
+#if SKIPLIST_HAS_IO_URING
+
+inline bool AsyncFileIO::setup_ring() {
+
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    _ring_fd = (int)syscall(__NR_io_uring_setup, ASYNC_RING_ENTRIES, &params);
+    if (_ring_fd < 0) {
+        perror("io_uring_setup, fall back to thread pool");
+        return false;
+    }
+
+    _sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    _cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        _sq_size = _cq_size = std::max(_sq_size, _cq_size);
+    }
+
+    _sq_ptr = mmap(nullptr, _sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQ_RING);
+    if (_sq_ptr == MAP_FAILED) {
+        perror("mmap sq ring");
+        _sq_ptr = nullptr;
+        close_ring();
+        return false;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        _cq_ptr = _sq_ptr;
+    } else {
+        _cq_ptr = mmap(nullptr, _cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_CQ_RING);
+        if (_cq_ptr == MAP_FAILED) {
+            perror("mmap cq ring");
+            _cq_ptr = nullptr;
+            close_ring();
+            return false;
+        }
+    }
+
+    _sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    _sqes = (io_uring_sqe*)mmap(nullptr, _sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQES);
+    if (_sqes == MAP_FAILED) {
+        perror("mmap sqes");
+        _sqes = nullptr;
+        close_ring();
+        return false;
+    }
+
+    char *sq = (char*)_sq_ptr;
+    _sq_head = (unsigned*)(sq + params.sq_off.head);
+    _sq_tail = (unsigned*)(sq + params.sq_off.tail);
+    _sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+    _sq_array = (unsigned*)(sq + params.sq_off.array);
+    _sq_entries = params.sq_entries;
+
+    char *cq = (char*)_cq_ptr;
+    _cq_head = (unsigned*)(cq + params.cq_off.head);
+    _cq_tail = (unsigned*)(cq + params.cq_off.tail);
+    _cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+    _cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+
+    // 注册失败（例如 RLIMIT_MEMLOCK 不足）时仍使用 io_uring，只是改用普通写入
+    std::vector<iovec> iovs(_buffers.size());
+    for (size_t i = 0; i < _buffers.size(); ++ i) {
+        iovs[i].iov_base = _buffers[i];
+        iovs[i].iov_len = ASYNC_IO_BUFFER_SIZE;
+    }
+    _registered = syscall(__NR_io_uring_register, _ring_fd, IORING_REGISTER_BUFFERS, iovs.data(), (unsigned)iovs.size()) == 0;
+    if (!_registered) {
+        perror("io_uring_register buffers");
+    }
+
+    _reaper = std::thread(&AsyncFileIO::reap, this);
+    return true;
+}
+
+
+// 用 user_data 为 0 的 NOP 通知收割线程退出
+inline void AsyncFileIO::close_ring() {
+
+    if (_reaper.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(_sq_mtx);
+            unsigned tail = *_sq_tail;
+            while (tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE) >= _sq_entries) {
+                syscall(__NR_io_uring_enter, _ring_fd, 0, 0, 0, nullptr, 0);
+            }
+            io_uring_sqe *sqe = &_sqes[tail & *_sq_mask];
+            memset(sqe, 0, sizeof(*sqe));
+            sqe -> opcode = IORING_OP_NOP;
+            sqe -> user_data = 0;
+            _sq_array[tail & *_sq_mask] = tail & *_sq_mask;
+            __atomic_store_n(_sq_tail, tail + 1, __ATOMIC_RELEASE);
+            syscall(__NR_io_uring_enter, _ring_fd, 1, 0, 0, nullptr, 0);
+        }
+        _reaper.join();
+    }
+
+    if (_sqes) {
+        munmap(_sqes, _sqes_size);
+        _sqes = nullptr;
+    }
+    if (_cq_ptr && _cq_ptr != _sq_ptr) {
+        munmap(_cq_ptr, _cq_size);
+    }
+    _cq_ptr = nullptr;
+    if (_sq_ptr) {
+        munmap(_sq_ptr, _sq_size);
+        _sq_ptr = nullptr;
+    }
+    if (_ring_fd >= 0) {
+        close(_ring_fd);
+        _ring_fd = -1;
+    }
+}
+
+
+// 把已放入提交队列的 queued 个请求交给内核，返回 0 或 -errno
+inline int AsyncFileIO::flush_sq(unsigned queued) {
+
+    while (queued > 0) {
+        int ret = (int)syscall(__NR_io_uring_enter, _ring_fd, queued, 0, 0, nullptr, 0);
+        if (ret < 0) {
+            int err = errno;
+            if (err == EINTR || err == EAGAIN || err == EBUSY) {
+                continue;
+            }
+            perror("io_uring_enter");
+            return -err;
+        }
+        queued -= (unsigned)ret < queued ? (unsigned)ret : queued;
+    }
+    return 0;
+}
+
+
+/*
+* 提交失败时收回内核尚未取走的提交项，它们和还没放入队列的请求一起以 -errno 完成，
+* 等待的协程照常恢复；已被内核取走的请求仍由收割线程完成
+*/
+inline void AsyncFileIO::submit(IoBatch *batch) {
+
+    std::lock_guard<std::mutex> lock(_sq_mtx);
+
+    size_t n = batch -> _ops.size();
+    size_t i = 0;
+    unsigned queued = 0;
+    int err = 0;
+    for (; i < n; ++ i) {
+        IoOp &op = batch -> _ops[i];
+
+        unsigned tail = *_sq_tail;
+        // 提交队列已满，先交给内核
+        if (tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE) >= _sq_entries) {
+            err = flush_sq(queued);
+            queued = 0;
+            if (err < 0) {
+                break;
+            }
+        }
+
+        io_uring_sqe *sqe = &_sqes[tail & *_sq_mask];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe -> fd = op.fd;
+        sqe -> user_data = (uint64_t)(uintptr_t)&op;
+        if (op.opcode == IoBatch::OP_WRITE) {
+            sqe -> addr = (uint64_t)(uintptr_t)op.data;
+            sqe -> len = op.len;
+            sqe -> off = (uint64_t)op.offset;
+            if (_registered && op.buf_index >= 0) {
+                sqe -> opcode = IORING_OP_WRITE_FIXED;
+                sqe -> buf_index = (uint16_t)op.buf_index;
+            } else {
+                sqe -> opcode = IORING_OP_WRITE;
+            }
+        } else {
+            sqe -> opcode = IORING_OP_FSYNC;
+            sqe -> fsync_flags = IORING_FSYNC_DATASYNC;
+            sqe -> flags = IOSQE_IO_DRAIN;
+        }
+        _sq_array[tail & *_sq_mask] = tail & *_sq_mask;
+        __atomic_store_n(_sq_tail, tail + 1, __ATOMIC_RELEASE);
+        ++ queued;
+    }
+
+    if (err == 0) {
+        err = flush_sq(queued);
+    }
+    if (err == 0) {
+        return ;
+    }
+
+    // 每次提交都在锁内交完，队列中剩下的只可能是本批最后放入的请求
+    unsigned head = __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+    unsigned unconsumed = *_sq_tail - head;
+    __atomic_store_n(_sq_tail, head, __ATOMIC_RELEASE);
+    for (size_t j = i - unconsumed; j < n; ++ j) {
+        complete(&batch -> _ops[j], err);
+    }
+}
+
+
+inline void AsyncFileIO::reap() {
+
+    bool stop = false;
+    while (!stop) {
+        int ret = (int)syscall(__NR_io_uring_enter, _ring_fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+        if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            perror("io_uring_enter wait");
+            return ;
+        }
+
+        unsigned head = *_cq_head;
+        unsigned tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++ head) {
+            io_uring_cqe *cqe = &_cqes[head & *_cq_mask];
+            if (cqe -> user_data == 0) {
+                stop = true;
+                continue;
+            }
+            complete((IoOp*)(uintptr_t)cqe -> user_data, cqe -> res);
+        }
+        __atomic_store_n(_cq_head, head, __ATOMIC_RELEASE);
+    }
+}
+
+#else
+
+inline bool AsyncFileIO::setup_ring() {
+    return false;
+}
+
+
+inline void AsyncFileIO::close_ring() {}
+
+
+inline void AsyncFileIO::submit(IoBatch *batch) {
+    submit_fallback(batch);
+}
+
+
+inline void AsyncFileIO::reap() {}
+
+#endif
+
+
+
+/*
+* Skiplist 的协程包装
+*
+* 打开写前日志（open_log）后 async_put 和 async_delete 是持久写：记录追加到日志并 fdatasync 之后才返回。
+* 直接在底层跳表上做的修改不写日志；读操作对过期时间的顺延也不写日志，重放时以插入时的过期时刻为准，
+* 已经过期的插入记录不再重放。
+* 每条记录为 [u32 标记][u32 负载长度][u32 校验和] 加 [u8 类型][i64 过期时刻]"key:value" 负载，
+* 重放时跳过校验不通过的记录。
+* 日志位置与内存修改在同一把锁内确定，日志顺序与内存中的修改顺序一致；
+* 内存修改先于日志落盘对读者可见，持久性只对 async_put 的调用方保证。
+* 包装对象销毁前所有异步操作必须已经完成。
+*/
+template<typename Key, typename Value, typename Traits = DefaultSkiplistTraits>
+class AsyncSkiplist {
+
+public:
+
+    using list_type = Skiplist<Key, Value, Traits>;
+
+    AsyncSkiplist(list_type&, SkiplistExecutor&);
+    ~AsyncSkiplist();
+
+    bool open_log(const std::string&);
+    int replay_log(const std::string&);
+    void close_log();
+    bool using_io_uring() const;
+
+    // key 不存在时插入（使用 ttl），已存在时只更新值；返回 0 插入、1 更新、-1 日志写入失败
+    AsyncTask<int> async_put(Key, Value, int ttl = -1);
+    // 删除 key；返回 0，日志写入失败返回 -1
+    AsyncTask<int> async_delete(Key);
+    AsyncTask<std::optional<Value>> async_get(Key);
+    // [lo, hi) 内的有效元素，按 key 升序
+    AsyncTask<std::vector<std::pair<Key, Value>>> async_scan(Key, Key);
+    // 快照格式与 dump_file 相同，先写临时文件再 rename；返回写入的字节数，失败返回 -1
+    AsyncTask<long> async_snapshot(std::string);
+
+private:
+
+    AsyncTask<long> write_file(int, const std::string&, off_t, bool);
+    static std::string log_record(AsyncLogOp, time_t, const std::string&);
+    static uint32_t log_checksum(const char*, uint32_t);
+
+    list_type &_list;
+    SkiplistExecutor &_executor;
+    AsyncFileIO _io;
+
+    int _log_fd{-1};
+    off_t _log_offset{0};
+    std::mutex _log_mtx;
+
+};
+
+
+template<typename Key, typename Value, typename Traits>
+AsyncSkiplist<Key, Value, Traits>::AsyncSkiplist(list_type &list, SkiplistExecutor &executor)
+    : _list(list), _executor(executor), _io(executor) {}
+
+
+template<typename Key, typename Value, typename Traits>
+AsyncSkiplist<Key, Value, Traits>::~AsyncSkiplist() {
+    close_log();
+}
+
+
+template<typename Key, typename Value, typename Traits>
+bool AsyncSkiplist<Key, Value, Traits>::using_io_uring() const {
+    return _io.using_io_uring();
+}
+
+
+template<typename Key, typename Value, typename Traits>
+bool AsyncSkiplist<Key, Value, Traits>::open_log(const std::string &path) {
+
+    close_log();
+    _log_fd = open(path.c_str(), O_WRONLY | O_CREAT, 0644);
+    if (_log_fd < 0) {
+        perror("open log");
+        return false;
+    }
+    _log_offset = lseek(_log_fd, 0, SEEK_END);
+    return true;
+}
+
+
+template<typename Key, typename Value, typename Traits>
+void AsyncSkiplist<Key, Value, Traits>::close_log() {
+    if (_log_fd >= 0) {
+        close(_log_fd);
+        _log_fd = -1;
+    }
+}
+
+
+// FNV-1a，覆盖负载长度与负载
+template<typename Key, typename Value, typename Traits>
+uint32_t AsyncSkiplist<Key, Value, Traits>::log_checksum(const char *data, uint32_t len) {
+    uint32_t h = 2166136261u;
+    const unsigned char *p = reinterpret_cast<const unsigned char*>(&len);
+    for (size_t i = 0; i < sizeof(len); ++ i) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    for (uint32_t i = 0; i < len; ++ i) {
+        h = (h ^ (unsigned char)data[i]) * 16777619u;
+    }
+    return h;
+}
+
+
+/*
+* 启动时同步重放日志，返回重放的记录数
+* 崩溃时尚未写完的记录会留下 '\0' 空洞或被截断的记录，遇到标记、长度或校验和不对时
+* 逐字节向后寻找下一条记录
+*/
+template<typename Key, typename Value, typename Traits>
+int AsyncSkiplist<Key, Value, Traits>::replay_log(const std::string &path) {
+
+    std::ifstream reader(path, std::ios::binary);
+    if (!reader.is_open()) {
+        return 0;
+    }
+    std::string data((std::istreambuf_iterator<char>(reader)), std::istreambuf_iterator<char>());
+
+    int count = 0;
+    size_t pos = 0;
+    while (pos + ASYNC_LOG_HEADER <= data.size()) {
+
+        uint32_t magic, len, check;
+        memcpy(&magic, data.data() + pos, 4);
+        memcpy(&len, data.data() + pos + 4, 4);
+        memcpy(&check, data.data() + pos + 8, 4);
+        if (magic != ASYNC_LOG_MAGIC || len > data.size() - pos - ASYNC_LOG_HEADER ||
+            log_checksum(data.data() + pos + ASYNC_LOG_HEADER, len) != check) {
+            ++ pos;
+            continue;
+        }
+
+        std::string record = data.substr(pos + ASYNC_LOG_HEADER, len);
+        pos += ASYNC_LOG_HEADER + len;
+        if (record.size() < ASYNC_LOG_PREFIX) {
+            continue;
+        }
+        unsigned char op = (unsigned char)record[0];
+        int64_t deadline;
+        memcpy(&deadline, record.data() + 1, sizeof(deadline));
+        record.erase(0, ASYNC_LOG_PREFIX);
+
+        Key key;
+        if (op == LOG_DELETE) {
+            if (record.empty()) {
+                continue;
+            }
+            parse_field(record, &key);
+            _list.delete_element(key);
+            ++ count;
+            continue;
+        }
+
+        size_t split = record.find(delimiter);
+        if (split == std::string::npos || split == 0) {
+            continue;
+        }
+        Value val;
+        parse_field(record.substr(0, split), &key);
+        parse_field(record.substr(split + 1), &val);
+
+        if (op == LOG_EDIT) {
+            // 对应的插入已过期时不再复活
+            if (_list.edit_elemnent(key, val) == 0) {
+                continue;
+            }
+        } else if (op != LOG_INSERT) {
+            continue;
+        } else if constexpr (Traits::enable_ttl) {
+            if (deadline > 0) {
+                if (_list.insert_element_until(key, val, (time_t)deadline) < 0) {
+                    continue;
+                }
+            } else if (_list.edit_elemnent(key, val) == 0) {
+                _list.insert_element(key, val);
+            }
+        } else if (_list.edit_elemnent(key, val) == 0) {
+            _list.insert_element(key, val);
+        }
+        ++ count;
+    }
+    return count;
+}
+
+
+template<typename Key, typename Value, typename Traits>
+std::string AsyncSkiplist<Key, Value, Traits>::log_record(AsyncLogOp op, time_t deadline, const std::string &body) {
+
+    int64_t value = (int64_t)deadline;
+    std::string payload(1, (char)op);
+    payload.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    payload += body;
+    uint32_t header[3] = {ASYNC_LOG_MAGIC, (uint32_t)payload.size(),
+                          log_checksum(payload.data(), (uint32_t)payload.size())};
+    std::string record(reinterpret_cast<const char*>(header), sizeof(header));
+    return record + payload;
+}
+
+
+template<typename Key, typename Value, typename Traits>
+AsyncTask<int> AsyncSkiplist<Key, Value, Traits>::async_put(Key key, Value val, int ttl) {
+
+    co_await _executor.schedule();
+
+    std::string record;
+    off_t offset = 0;
+    int ret;
+    {
+        std::lock_guard<std::mutex> lock(_log_mtx);
+        ret = _list.edit_elemnent(key, val);
+        time_t deadline = 0;
+        if (ret == 0) {
+            _list.insert_element(key, val, ttl);
+            if (Traits::enable_ttl && ttl > 0) {
+                deadline = time(nullptr) + ttl;
+            }
+        }
+        if (_log_fd >= 0) {
+            std::ostringstream out;
+            out << key << delimiter << val;
+            record = log_record(ret == 0 ? LOG_INSERT : LOG_EDIT, deadline, out.str());
+            offset = _log_offset;
+            _log_offset += (off_t)record.size();
+        }
+    }
+
+    if (!record.empty()) {
+        long written = co_await write_file(_log_fd, record, offset, true);
+        if (written < 0) {
+            co_return -1;
+        }
+    }
+    co_return ret;
+}
+
+
+template<typename Key, typename Value, typename Traits>
+AsyncTask<int> AsyncSkiplist<Key, Value, Traits>::async_delete(Key key) {
+
+    co_await _executor.schedule();
+
+    std::string record;
+    off_t offset = 0;
+    {
+        std::lock_guard<std::mutex> lock(_log_mtx);
+        _list.delete_element(key);
+        if (_log_fd >= 0) {
+            std::ostringstream out;
+            out << key;
+            record = log_record(LOG_DELETE, 0, out.str());
+            offset = _log_offset;
+            _log_offset += (off_t)record.size();
+        }
+    }
+
+    if (!record.empty()) {
+        long written = co_await write_file(_log_fd, record, offset, true);
+        if (written < 0) {
+            co_return -1;
+        }
+    }
+    co_return 0;
+}
+
+
+template<typename Key, typename Value, typename Traits>
+AsyncTask<std::optional<Value>> AsyncSkiplist<Key, Value, Traits>::async_get(Key key) {
+
+    co_await _executor.schedule();
+
+    Value val;
+    if (_list.search_element(key, &val)) {
+        co_return std::optional<Value>(std::move(val));
+    }
+    co_return std::optional<Value>();
+}
+
+
+template<typename Key, typename Value, typename Traits>
+AsyncTask<std::vector<std::pair<Key, Value>>> AsyncSkiplist<Key, Value, Traits>::async_scan(Key lo, Key hi) {
+
+    co_await _executor.schedule();
+
+    std::vector<std::pair<Key, Value>> result;
+    _list.scan(lo, hi, [&result](const Key &key, const Value &val) {
+        result.emplace_back(key, val);
+    });
+    co_return result;
+}
+
+
+/*
+* 读锁只在序列化期间持有，写文件时不再占用跳表
+*/
+template<typename Key, typename Value, typename Traits>
+AsyncTask<long> AsyncSkiplist<Key, Value, Traits>::async_snapshot(std::string path) {
+
+    co_await _executor.schedule();
+
+    std::ostringstream out;
+    _list.snapshot([]() {}, [&out](const Key &key, const Value &val) {
+        out << key << delimiter << val << "\n";
+    });
+    std::string data = out.str();
+
+    std::string tmp_path = path + ".tmp";
+    int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror("open snapshot");
+        co_return -1;
+    }
+
+    long written = co_await write_file(fd, data, 0, true);
+    close(fd);
+    if (written < 0) {
+        errno = (int)-written;
+        perror("write snapshot");
+        unlink(tmp_path.c_str());
+        co_return -1;
+    }
+    if (rename(tmp_path.c_str(), path.c_str()) != 0) {
+        perror("rename snapshot");
+        co_return -1;
+    }
+    co_return written;
+}
+
+
+/*
+* 按注册缓冲区大小分块写入，每批尽量多占用几个空闲缓冲区以便多个写入同时在途；
+* 第一块之外只取当前空闲的缓冲区，避免多个快照互相等待对方持有的缓冲区
+*/
+template<typename Key, typename Value, typename Traits>
+AsyncTask<long> AsyncSkiplist<Key, Value, Traits>::write_file(int fd, const std::string &data, off_t offset, bool sync) {
+
+    if (data.empty()) {
+        if (!sync) {
+            co_return 0;
+        }
+        IoBatch batch(_io);
+        batch.fsync(fd);
+        co_return co_await batch;
+    }
+
+    long total = 0;
+    size_t pos = 0;
+    while (pos < data.size()) {
+
+        IoBatch batch(_io);
+        std::vector<int> held;
+
+        int index = co_await _io.acquire_buffer();
+        while (index >= 0 && pos < data.size()) {
+            unsigned len = (unsigned)std::min((size_t)ASYNC_IO_BUFFER_SIZE, data.size() - pos);
+            memcpy(_io.buffer(index), data.data() + pos, len);
+            batch.write(fd, _io.buffer(index), len, offset + (off_t)pos, index);
+            held.push_back(index);
+            pos += len;
+            index = pos < data.size() ? _io.try_acquire_buffer() : -1;
+        }
+        if (sync && pos >= data.size()) {
+            batch.fsync(fd);
+        }
+
+        long ret = co_await batch;
+        for (int i : held) {
+            _io.release_buffer(i);
+        }
+        if (ret < 0) {
+            co_return ret;
+        }
+        total += ret;
+    }
+    co_return total;
+}
+
+
+#endif
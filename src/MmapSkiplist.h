@@ -0,0 +1,748 @@
+#ifndef MMAP_SKIPLIST_H
+#define MMAP_SKIPLIST_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*
+* 基于内存映射文件的持久化跳表
+*
+* 节点与各层的后继指针都存放在映射文件中，指针使用相对文件起始处的偏移量，
+* 因此重新打开文件即可直接使用，无需解析文件或重放 insert_element。
+*
+* 文件布局：[MmapFileHeader][header node][arena ...]
+* 崩溃一致性：节点内容先落盘，再链接第 0 层，最后链接上层；
+* 未正常关闭的文件在打开时执行 recover()，校验第 0 层并重建上层索引。
+*/
+
+#define MMAP_STORE_FILE "store/skiplist.mmap"   // 默认映射文件路径
+#define MMAP_MAX_LEVEL 32                       // 支持的最大层数
+#define MMAP_INIT_SIZE (1 << 20)                // 新建文件的初始大小
+
+static const uint64_t MMAP_MAGIC = 0x4c50494b534d4d41ULL; // "AMMSKIPL"
+static const uint32_t MMAP_VERSION = 1;
+
+
+struct MmapFileHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t max_level;
+    uint32_t key_size;                     // 用于校验 Key/Value 类型是否一致
+    uint32_t val_size;
+    uint64_t file_size;                    // 当前映射文件大小
+    uint64_t arena_top;                    // arena 下一个可分配位置
+    uint64_t header_node;                  // 头节点偏移
+    uint64_t element_count;
+    uint64_t free_list[MMAP_MAX_LEVEL + 1];  // 按层数划分的空闲节点链表
+    int32_t skip_list_level;
+    uint32_t clean;                        // 正常关闭标记，为 0 时需要恢复
+};
+
+
+/*
+* 映射文件中的节点，forward 偏移数组紧跟在结构体之后，共 node_level + 1 项
+*/
+template<typename Key, typename Value>
+struct alignas(8) MmapNode {
+    Key key;
+    Value val;
+    int64_t end_time;
+    int32_t ttl;
+    uint32_t check;       // key 与层数的校验值，恢复时识别未写完的节点
+    uint16_t node_level;
+    uint8_t deleted;
+    uint8_t timed;
+
+    uint64_t *forward() {
+        return reinterpret_cast<uint64_t*>(reinterpret_cast<char*>(this) + sizeof(MmapNode));
+    }
+
+    bool is_timeout() const {
+        return is_timeout(time(nullptr));
+    }
+
+    bool is_timeout(time_t now) const {
+        return timed && (now > end_time);
+    }
+};
+
+
+template<typename Key, typename Value>
+class MmapSkiplist {
+
+    static_assert(std::is_trivially_copyable<Key>::value, "MmapSkiplist key must be trivially copyable");
+    static_assert(std::is_trivially_copyable<Value>::value, "MmapSkiplist value must be trivially copyable");
+
+    typedef MmapNode<Key, Value> Node;
+
+private:
+
+    std::string _path;
+    int _fd;
+    char *_base;                 // 映射起始地址，扩容后可能变化
+    int _max_level;
+    bool _sync_each_write;       // 每次写操作都执行 msync 屏障，默认开启；关闭后崩溃可能丢失第 0 层尾部
+    bool _recovered;             // 本次打开是否经过崩溃恢复
+
+    std::shared_mutex rw_mtx;
+
+public:
+
+    MmapSkiplist(int);
+    MmapSkiplist(const std::string&, int);
+    MmapSkiplist(const std::string&, int, bool);
+    ~MmapSkiplist();
+
+    bool is_open() const;
+    bool recovered() const;
+
+    int get_random_level();
+    int insert_element(const Key&, const Value&);
+    int insert_element(const Key&, const Value&, int);
+    bool search_element(const Key&);
+    bool search_element(const Key&, Value*);
+    void delete_element(const Key&);
+    int edit_element(const Key&, const Value&);
+    void display_list();
+    void compact();
+    void sync();
+    int size() const;
+
+private:
+
+    MmapFileHeader *file_header() const;
+    Node *node_at(uint64_t) const;
+    static size_t node_bytes(int);
+    static uint32_t node_check(const Key&, int);
+
+    bool open_file();
+    bool init_file();
+    bool grow(uint64_t);
+    uint64_t allocate_node(int);
+    void free_node(uint64_t);
+    void barrier(const void*, size_t);
+    void recover();
+
+    Node *find_greater_or_equal(const Key&, uint64_t*);
+
+};
+
+
+template<typename Key, typename Value>
+MmapSkiplist<Key, Value>::MmapSkiplist(const int max_level) : MmapSkiplist(MMAP_STORE_FILE, max_level) {}
+
+template<typename Key, typename Value>
+MmapSkiplist<Key, Value>::MmapSkiplist(const std::string &path, const int max_level) : MmapSkiplist(path, max_level, true) {}
+
+template<typename Key, typename Value>
+MmapSkiplist<Key, Value>::MmapSkiplist(const std::string &path, const int max_level, bool sync_each_write) :
+    _path(path),
+    _fd(-1),
+    _base(nullptr),
+    _max_level(max_level < MMAP_MAX_LEVEL ? max_level : MMAP_MAX_LEVEL),
+    _sync_each_write(sync_each_write),
+    _recovered(false) {
+
+    if (!open_file()) {
+        std::cerr << "MmapSkiplist: failed to open " << _path << std::endl;
+    }
+}
+
+
+template<typename Key, typename Value>
+MmapSkiplist<Key, Value>::~MmapSkiplist() {
+
+    if (_base != nullptr) {
+        sync();
+        // 所有数据落盘后再写入正常关闭标记
+        file_header() -> clean = 1;
+        msync(_base, sizeof(MmapFileHeader), MS_SYNC);
+        munmap(_base, file_header() -> file_size);
+    }
+    if (_fd >= 0) {
+        close(_fd);
+    }
+}
+
+
+template<typename Key, typename Value>
+bool MmapSkiplist<Key, Value>::is_open() const {
+    return _base != nullptr;
+}
+
+
+template<typename Key, typename Value>
+bool MmapSkiplist<Key, Value>::recovered() const {
+    return _recovered;
+}
+
+
+template<typename Key, typename Value>
+MmapFileHeader *MmapSkiplist<Key, Value>::file_header() const {
+    return reinterpret_cast<MmapFileHeader*>(_base);
+}
+
+
+template<typename Key, typename Value>
+MmapNode<Key, Value> *MmapSkiplist<Key, Value>::node_at(uint64_t off) const {
+    return off ? reinterpret_cast<Node*>(_base + off) : nullptr;
+}
+
+
+template<typename Key, typename Value>
+size_t MmapSkiplist<Key, Value>::node_bytes(int level) {
+    return sizeof(Node) + sizeof(uint64_t) * (level + 1);
+}
+
+
+template<typename Key, typename Value>
+uint32_t MmapSkiplist<Key, Value>::node_check(const Key &key, int level) {
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    const unsigned char *p = reinterpret_cast<const unsigned char*>(&key);
+    for (size_t i = 0; i < sizeof(Key); ++ i) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return (h ^ static_cast<uint32_t>(level)) * 16777619u;
+}
+
+
+
+template<typename Key, typename Value>
+bool MmapSkiplist<Key, Value>::open_file() {
+
+    _fd = open(_path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (_fd < 0) {
+        perror("open");
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(_fd, &st) != 0) {
+        perror("fstat");
+        return false;
+    }
+
+    if (st.st_size == 0) {
+        return init_file();
+    }
+
+    if (static_cast<size_t>(st.st_size) < sizeof(MmapFileHeader)) {
+        std::cerr << "MmapSkiplist: " << _path << " is truncated" << std::endl;
+        return false;
+    }
+
+    void *addr = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+    if (addr == MAP_FAILED) {
+        perror("mmap");
+        return false;
+    }
+    _base = static_cast<char*>(addr);
+
+    MmapFileHeader *hdr = file_header();
+    if (hdr -> magic != MMAP_MAGIC || hdr -> version != MMAP_VERSION ||
+        hdr -> key_size != sizeof(Key) || hdr -> val_size != sizeof(Value)) {
+        std::cerr << "MmapSkiplist: " << _path << " has an incompatible layout" << std::endl;
+        munmap(_base, st.st_size);
+        _base = nullptr;
+        return false;
+    }
+
+    // 层数与偏移越界说明文件损坏，恢复时会按这些值访问头节点和栈上数组
+    uint64_t size = static_cast<uint64_t>(st.st_size);
+    if (hdr -> max_level > MMAP_MAX_LEVEL || hdr -> skip_list_level < 0 ||
+        hdr -> skip_list_level > static_cast<int32_t>(hdr -> max_level) ||
+        hdr -> header_node < sizeof(MmapFileHeader) || hdr -> header_node % 8 != 0 ||
+        hdr -> header_node + node_bytes(hdr -> max_level) > size ||
+        hdr -> arena_top > size || hdr -> arena_top < hdr -> header_node + node_bytes(hdr -> max_level)) {
+        std::cerr << "MmapSkiplist: " << _path << " has a corrupt header" << std::endl;
+        munmap(_base, st.st_size);
+        _base = nullptr;
+        return false;
+    }
+
+    // 层数以文件中记录的为准，头节点的 forward 数组大小由它决定
+    _max_level = hdr -> max_level;
+    hdr -> file_size = st.st_size;
+
+    if (!hdr -> clean) {
+        recover();
+        _recovered = true;
+    }
+
+    hdr -> clean = 0;
+    msync(_base, sizeof(MmapFileHeader), MS_SYNC);
+    return true;
+}
+
+
+template<typename Key, typename Value>
+bool MmapSkiplist<Key, Value>::init_file() {
+
+    if (ftruncate(_fd, MMAP_INIT_SIZE) != 0) {
+        perror("ftruncate");
+        return false;
+    }
+
+    void *addr = mmap(nullptr, MMAP_INIT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+    if (addr == MAP_FAILED) {
+        perror("mmap");
+        return false;
+    }
+    _base = static_cast<char*>(addr);
+
+    MmapFileHeader *hdr = file_header();
+    memset(hdr, 0, sizeof(MmapFileHeader));
+    hdr -> magic = MMAP_MAGIC;
+    hdr -> version = MMAP_VERSION;
+    hdr -> max_level = _max_level;
+    hdr -> key_size = sizeof(Key);
+    hdr -> val_size = sizeof(Value);
+    hdr -> file_size = MMAP_INIT_SIZE;
+    hdr -> arena_top = (sizeof(MmapFileHeader) + 7) & ~static_cast<uint64_t>(7);
+
+    hdr -> header_node = allocate_node(_max_level);
+    Node *head = node_at(hdr -> header_node);
+    memset(head, 0, node_bytes(_max_level));
+    head -> node_level = _max_level;
+
+    msync(_base, MMAP_INIT_SIZE, MS_SYNC);
+    return true;
+}
+
+
+/*
+* 扩容映射文件，扩容后 _base 可能变化，调用方不能持有节点指针
+*/
+template<typename Key, typename Value>
+bool MmapSkiplist<Key, Value>::grow(uint64_t need) {
+
+    uint64_t old_size = file_header() -> file_size;
+    uint64_t new_size = old_size;
+    while (new_size < need) {
+        new_size *= 2;
+    }
+
+    if (ftruncate(_fd, new_size) != 0) {
+        perror("ftruncate");
+        return false;
+    }
+
+    void *addr = mremap(_base, old_size, new_size, MREMAP_MAYMOVE);
+    if (addr == MAP_FAILED) {
+        perror("mremap");
+        return false;
+    }
+    _base = static_cast<char*>(addr);
+    file_header() -> file_size = new_size;
+    return true;
+}
+
+
+template<typename Key, typename Value>
+uint64_t MmapSkiplist<Key, Value>::allocate_node(int level) {
+
+    MmapFileHeader *hdr = file_header();
+
+    // 优先复用同层数的空闲节点
+    if (hdr -> free_list[level]) {
+        uint64_t off = hdr -> free_list[level];
+        hdr -> free_list[level] = node_at(off) -> forward()[0];
+        return off;
+    }
+
+    uint64_t off = hdr -> arena_top;
+    if (off + node_bytes(level) > hdr -> file_size) {
+        if (!grow(off + node_bytes(level))) {
+            return 0;
+        }
+        hdr = file_header();
+    }
+    hdr -> arena_top = off + node_bytes(level);
+    return off;
+}
+
+
+template<typename Key, typename Value>
+void MmapSkiplist<Key, Value>::free_node(uint64_t off) {
+    MmapFileHeader *hdr = file_header();
+    Node *node = node_at(off);
+    node -> check = 0;
+    node -> forward()[0] = hdr -> free_list[node -> node_level];
+    hdr -> free_list[node -> node_level] = off;
+}
+
+
+/*
+* 有序刷盘点：仅在 _sync_each_write 模式下生效（默认开启），
+* 保证屏障之前的写入先于之后的写入落盘
+*/
+template<typename Key, typename Value>
+void MmapSkiplist<Key, Value>::barrier(const void *addr, size_t len) {
+
+    if (!_sync_each_write) {
+        return ;
+    }
+    static const uintptr_t page = sysconf(_SC_PAGESIZE);
+    uintptr_t begin = reinterpret_cast<uintptr_t>(addr) & ~(page - 1);
+    uintptr_t end = reinterpret_cast<uintptr_t>(addr) + len;
+    msync(reinterpret_cast<void*>(begin), end - begin, MS_SYNC);
+}
+
+
+/*
+* 崩溃恢复：沿第 0 层校验每个节点（偏移越界、校验值不符、key 非递增即截断），
+* 丢弃空闲链表，重新统计元素个数并重建第 1 层及以上的索引
+*/
+template<typename Key, typename Value>
+void MmapSkiplist<Key, Value>::recover() {
+
+    MmapFileHeader *hdr = file_header();
+    uint64_t file_size = hdr -> file_size;
+    uint64_t arena_top = hdr -> arena_top;
+
+    Node *head = node_at(hdr -> header_node);
+    Node *last[MMAP_MAX_LEVEL + 1];
+    for (int i = 0; i <= _max_level; ++ i) {
+        last[i] = head;
+    }
+
+    uint64_t count = 0;
+    int level = 0;
+    Node *prev = head;
+    uint64_t off = head -> forward()[0];
+
+    while (off) {
+
+        bool valid = off % 8 == 0 && off >= sizeof(MmapFileHeader) && off + sizeof(Node) <= file_size;
+        Node *node = valid ? node_at(off) : nullptr;
+        valid = valid && node -> node_level <= _max_level &&
+                off + node_bytes(node -> node_level) <= file_size &&
+                node -> check == node_check(node -> key, node -> node_level) &&
+                (prev == head || prev -> key < node -> key);
+
+        if (!valid) {
+            std::cerr << "MmapSkiplist: truncating list at offset " << off << std::endl;
+            prev -> forward()[0] = 0;
+            break;
+        }
+
+        for (int i = 1; i <= node -> node_level; ++ i) {
+            last[i] -> forward()[i] = off;
+            last[i] = node;
+        }
+        if (node -> node_level > level) {
+            level = node -> node_level;
+        }
+        if (off + node_bytes(node -> node_level) > arena_top) {
+            arena_top = off + node_bytes(node -> node_level);
+        }
+
+        ++ count;
+        prev = node;
+        off = node -> forward()[0];
+    }
+
+    for (int i = 1; i <= _max_level; ++ i) {
+        last[i] -> forward()[i] = 0;
+    }
+
+    // 空闲链表可能不完整，直接丢弃（最多泄漏部分空间）
+    memset(hdr -> free_list, 0, sizeof(hdr -> free_list));
+    hdr -> arena_top = arena_top;
+    hdr -> element_count = count;
+    hdr -> skip_list_level = level;
+
+    msync(_base, file_size, MS_SYNC);
+}
+
+
+
+template<typename Key, typename Value>
+int MmapSkiplist<Key, Value>::get_random_level(){
+    int k = 1;
+    while(rand() % 2 == 1){
+        ++ k;
+    }
+    k = (k < _max_level) ? k : _max_level;
+    return k;
+}
+
+
+/*
+* 查找第一个 key 不小于给定值的节点，update 记录每层前驱的偏移（可为空）
+*/
+template<typename Key, typename Value>
+MmapNode<Key, Value> *MmapSkiplist<Key, Value>::find_greater_or_equal(const Key &key, uint64_t *update) {
+
+    MmapFileHeader *hdr = file_header();
+    uint64_t current = hdr -> header_node;
+
+    for (int i = hdr -> skip_list_level; i >= 0; -- i) {
+        uint64_t next = node_at(current) -> forward()[i];
+        while (next && node_at(next) -> key < key) {
+            current = next;
+            next = node_at(current) -> forward()[i];
+        }
+        if (update) {
+            update[i] = current;
+        }
+    }
+    return node_at(node_at(current) -> forward()[0]);
+}
+
+
+
+template<typename Key, typename Value>
+int MmapSkiplist<Key, Value>::insert_element(const Key &key, const Value &val) {
+    return insert_element(key, val, -1);
+}
+
+
+template<typename Key, typename Value>
+int MmapSkiplist<Key, Value>::insert_element(const Key &key, const Value &val, int ttl) {
+
+    if (_base == nullptr) {
+        return -1;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(rw_mtx);
+
+    uint64_t update[MMAP_MAX_LEVEL + 1];
+    Node *current = find_greater_or_equal(key, update);
+
+    if (current != nullptr && !(key < current -> key)) {
+        if (!current -> deleted && !current -> is_timeout()) {
+            std::cout << "Key: " << key << ", exists. \n";
+            return 1;
+        }
+        // 复用已删除的同 key 节点
+        current -> val = val;
+        current -> ttl = ttl;
+        current -> timed = ttl > 0;
+        current -> end_time = ttl > 0 ? time(nullptr) + ttl : 0;
+        current -> deleted = 0;
+        barrier(current, sizeof(Node));
+        return 0;
+    }
+
+    int random_level = get_random_level();
+    MmapFileHeader *hdr = file_header();
+    if (random_level > hdr -> skip_list_level) {
+        for (int i = hdr -> skip_list_level + 1; i <= random_level; ++ i) {
+            update[i] = hdr -> header_node;
+        }
+        hdr -> skip_list_level = random_level;
+    }
+
+    // 分配可能触发扩容，之后才能取节点指针
+    uint64_t off = allocate_node(random_level);
+    if (off == 0) {
+        return -1;
+    }
+    hdr = file_header();
+
+    Node *node = node_at(off);
+    memcpy(&node -> key, &key, sizeof(Key));
+    memcpy(&node -> val, &val, sizeof(Value));
+    node -> ttl = ttl;
+    node -> timed = ttl > 0;
+    node -> end_time = ttl > 0 ? time(nullptr) + ttl : 0;
+    node -> deleted = 0;
+    node -> node_level = random_level;
+    node -> check = node_check(key, random_level);
+    for (int i = 0; i <= random_level; ++ i) {
+        node -> forward()[i] = node_at(update[i]) -> forward()[i];
+    }
+
+    // 1. 节点内容及分配信息落盘
+    barrier(node, node_bytes(random_level));
+    barrier(hdr, sizeof(MmapFileHeader));
+
+    // 2. 链接第 0 层，此后节点对恢复流程可见
+    node_at(update[0]) -> forward()[0] = off;
+    barrier(&node_at(update[0]) -> forward()[0], sizeof(uint64_t));
+
+    // 3. 上层只是索引，崩溃后由 recover() 重建
+    for (int i = 1; i <= random_level; ++ i) {
+        node_at(update[i]) -> forward()[i] = off;
+    }
+
+    ++ hdr -> element_count;
+    return 0;
+}
+
+
+template<typename Key, typename Value>
+bool MmapSkiplist<Key, Value>::search_element(const Key &key) {
+    return search_element(key, nullptr);
+}
+
+
+template<typename Key, typename Value>
+bool MmapSkiplist<Key, Value>::search_element(const Key &key, Value *val) {
+
+    if (_base == nullptr) {
+        return false;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(rw_mtx);
+
+    Node *current = find_greater_or_equal(key, nullptr);
+    if (current == nullptr || key < current -> key || current -> deleted || current -> is_timeout()) {
+        return false;
+    }
+    if (val) {
+        *val = current -> val;
+    }
+    return true;
+}
+
+
+/*
+* 惰性删除，仅持久化 deleted 标记，空间由 compact() 回收
+*/
+template<typename Key, typename Value>
+void MmapSkiplist<Key, Value>::delete_element(const Key &key) {
+
+    if (_base == nullptr) {
+        return ;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(rw_mtx);
+
+    Node *current = find_greater_or_equal(key, nullptr);
+    if (current != nullptr && !(key < current -> key) && !current -> deleted) {
+        current -> deleted = 1;
+        barrier(&current -> deleted, sizeof(current -> deleted));
+    }
+}
+
+
+template<typename Key, typename Value>
+int MmapSkiplist<Key, Value>::edit_element(const Key &key, const Value &val) {
+
+    if (_base == nullptr) {
+        return 0;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(rw_mtx);
+
+    Node *current = find_greater_or_equal(key, nullptr);
+    if (current == nullptr || key < current -> key || current -> deleted || current -> is_timeout()) {
+        return 0;
+    }
+
+    memcpy(&current -> val, &val, sizeof(Value));
+    if (current -> timed) {
+        current -> end_time = time(nullptr) + current -> ttl;
+    }
+    barrier(current, sizeof(Node));
+    return 1;
+}
+
+
+/*
+* 物理删除已标记删除或已过期的节点，节点放回对应层数的空闲链表
+*/
+template<typename Key, typename Value>
+void MmapSkiplist<Key, Value>::compact() {
+
+    if (_base == nullptr) {
+        return ;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(rw_mtx);
+
+    MmapFileHeader *hdr = file_header();
+    Node *head = node_at(hdr -> header_node);
+
+    // 各层使用同一时刻判断过期，否则节点可能在上层保留、在第 0 层被释放后又被复用
+    time_t now = time(nullptr);
+
+    // 先摘除上层，最后摘除第 0 层，崩溃时第 0 层仍完整
+    for (int i = hdr -> skip_list_level; i >= 0; -- i) {
+
+        Node *prev = head;
+        uint64_t current = head -> forward()[i];
+        while (current) {
+            Node *node = node_at(current);
+            if (node -> deleted || node -> is_timeout(now)) {
+                prev -> forward()[i] = node -> forward()[i];
+                if (i == 0) {
+                    barrier(&prev -> forward()[0], sizeof(uint64_t));
+                    uint64_t next = node -> forward()[0];
+                    free_node(current);
+                    -- hdr -> element_count;
+                    current = next;
+                    continue;
+                }
+            } else {
+                prev = node;
+            }
+            current = node -> forward()[i];
+        }
+    }
+
+    while (hdr -> skip_list_level > 0 && head -> forward()[hdr -> skip_list_level] == 0) {
+        -- hdr -> skip_list_level;
+    }
+    barrier(hdr, sizeof(MmapFileHeader));
+}
+
+
+template<typename Key, typename Value>
+void MmapSkiplist<Key, Value>::sync() {
+
+    if (_base == nullptr) {
+        return ;
+    }
+    std::unique_lock<std::shared_mutex> lock(rw_mtx);
+    msync(_base, file_header() -> arena_top, MS_SYNC);
+}
+
+
+template<typename Key, typename Value>
+int MmapSkiplist<Key, Value>::size() const {
+    return _base ? static_cast<int>(file_header() -> element_count) : 0;
+}
+
+
+template<typename Key, typename Value>
+void MmapSkiplist<Key, Value>::display_list() {
+
+    if (_base == nullptr) {
+        return ;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(rw_mtx);
+
+    MmapFileHeader *hdr = file_header();
+    for (int i = hdr -> skip_list_level; i >= 0; -- i) {
+        Node *current = node_at(node_at(hdr -> header_node) -> forward()[i]);
+        std::cout << "Level " << i << " ";
+        while (current != nullptr) {
+            if (!current -> deleted && !current -> is_timeout()) {
+                std::cout << " " << current -> key << ":" << current -> val << " ";
+            }
+            current = node_at(current -> forward()[i]);
+        }
+        std::cout << "\n";
+    }
+}
+
+#endif
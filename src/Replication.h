@@ -0,0 +1,921 @@
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Skiplist.h"
+
+/*
+* 基于 Unix 域套接字的日志复制
+*
+* leader 订阅 Skiplist 的变更，为每个事件分配递增序号并缓存在内存日志中；
+* follower 连接后先收到一份快照（快照对应的序号为 S），再收到序号大于 S 的日志尾部，
+* 之后持续接收新事件并异步应用到自己的 Skiplist 上。
+*
+* 日志最多保留 REPL_MAX_LOG_EVENTS 个事件，落后更多的 follower 不再占用日志，
+* 其会话随后在同一连接上重新发送快照。
+*
+* 帧格式：[u32 负载长度][u8 帧类型][负载]，整数均为小端。
+* 插入事件与快照条目携带绝对过期时刻，follower 以固定的过期时刻写入，到期后读取不可见，
+* 物理删除仍以 leader 发出的 OP_EXPIRE 为准。leader 启用 LRU 时访问会延长过期时间，
+* 这种延长不复制，follower 可能比 leader 更早隐藏该 key。
+*/
+
+#define REPL_BATCH_SIZE 4096          // 每次发送的最大事件数
+#define REPL_HEARTBEAT_MS 100         // 空闲时心跳间隔
+#define REPL_FLUSH_BYTES (64 * 1024)  // 发送缓冲达到该大小时写出
+#ifndef REPL_MAX_LOG_EVENTS
+#define REPL_MAX_LOG_EVENTS (1 << 20) // 内存日志的最大事件数
+#endif
+
+
+enum FrameType {
+    FRAME_EVENT = 1,
+    FRAME_SNAPSHOT_BEGIN,
+    FRAME_SNAPSHOT_ENTRY,
+    FRAME_SNAPSHOT_END,
+    FRAME_HEARTBEAT,     // 负载为 leader 当前最新序号
+    FRAME_ACK,           // follower -> leader，负载为已应用的序号
+};
+
+
+template<typename T>
+std::string format_field(const T &val) {
+    std::ostringstream out;
+    out << val;
+    return out.str();
+}
+
+inline std::string format_field(const std::string &val) {
+    return val;
+}
+
+
+
+struct ReplCodec {
+
+    static void put_u32(std::string &buf, uint32_t v) {
+        for (int i = 0; i < 4; ++ i) {
+            buf.push_back(static_cast<char>(v >> (8 * i)));
+        }
+    }
+
+    static void put_u64(std::string &buf, uint64_t v) {
+        for (int i = 0; i < 8; ++ i) {
+            buf.push_back(static_cast<char>(v >> (8 * i)));
+        }
+    }
+
+    static void put_str(std::string &buf, const std::string &s) {
+        put_u32(buf, s.size());
+        buf.append(s);
+    }
+
+    static bool get_u32(const std::string &buf, size_t *pos, uint32_t *v) {
+        if (*pos + 4 > buf.size()) {
+            return false;
+        }
+        *v = 0;
+        for (int i = 0; i < 4; ++ i) {
+            *v |= static_cast<uint32_t>(static_cast<unsigned char>(buf[*pos + i])) << (8 * i);
+        }
+        *pos += 4;
+        return true;
+    }
+
+    static bool get_u64(const std::string &buf, size_t *pos, uint64_t *v) {
+        if (*pos + 8 > buf.size()) {
+            return false;
+        }
+        *v = 0;
+        for (int i = 0; i < 8; ++ i) {
+            *v |= static_cast<uint64_t>(static_cast<unsigned char>(buf[*pos + i])) << (8 * i);
+        }
+        *pos += 8;
+        return true;
+    }
+
+    static bool get_str(const std::string &buf, size_t *pos, std::string *s) {
+        uint32_t len;
+        if (!get_u32(buf, pos, &len) || *pos + len > buf.size()) {
+            return false;
+        }
+        s -> assign(buf, *pos, len);
+        *pos += len;
+        return true;
+    }
+
+    // 先写入帧头占位，负载写完后由 end_frame 回填长度
+    static size_t begin_frame(std::string &buf, FrameType type) {
+        size_t off = buf.size();
+        put_u32(buf, 0);
+        buf.push_back(static_cast<char>(type));
+        return off;
+    }
+
+    static void end_frame(std::string &buf, size_t off) {
+        uint32_t len = buf.size() - off - 5;
+        for (int i = 0; i < 4; ++ i) {
+            buf[off + i] = static_cast<char>(len >> (8 * i));
+        }
+    }
+
+    static void put_seq_frame(std::string &buf, FrameType type, uint64_t seq) {
+        size_t off = begin_frame(buf, type);
+        put_u64(buf, seq);
+        end_frame(buf, off);
+    }
+
+    static bool send_all(int fd, const std::string &buf) {
+        size_t sent = 0;
+        while (sent < buf.size()) {
+            ssize_t n = send(fd, buf.data() + sent, buf.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            sent += n;
+        }
+        return true;
+    }
+
+    static bool recv_all(int fd, char *data, size_t len) {
+        size_t got = 0;
+        while (got < len) {
+            ssize_t n = recv(fd, data + got, len - got, 0);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            got += n;
+        }
+        return true;
+    }
+
+    static bool read_frame(int fd, FrameType *type, std::string *payload) {
+        char head[5];
+        if (!recv_all(fd, head, sizeof(head))) {
+            return false;
+        }
+        std::string h(head, 4);
+        size_t pos = 0;
+        uint32_t len = 0;
+        get_u32(h, &pos, &len);
+        *type = static_cast<FrameType>(static_cast<unsigned char>(head[4]));
+        payload -> resize(len);
+        return len == 0 || recv_all(fd, &(*payload)[0], len);
+    }
+};
+
+
+
+template<typename Key, typename Value, typename Traits = DefaultSkiplistTraits>
+class ReplicationLeader {
+
+    static_assert(Traits::enable_change_feed, "ReplicationLeader requires enable_change_feed");
+
+    typedef ChangeEvent<Key, Value> Event;
+
+    struct Session {
+        int fd;
+        std::thread thread;
+        bool ready{false};                          // 快照序号确定后才参与日志裁剪
+        bool resync{false};                         // 落后超过日志上限，需要重新发送快照
+        unsigned long long cursor{0};               // 已发送的最大序号
+        std::atomic<unsigned long long> acked{0};   // follower 已应用的序号
+        std::atomic<bool> alive{true};
+    };
+
+private:
+
+    Skiplist<Key, Value, Traits> &_list;
+    std::string _path;
+    int _listen_fd;
+    std::thread _accept_thread;
+    std::atomic<bool> _running{false};
+
+    std::mutex _log_mtx;
+    std::condition_variable _log_cv;
+    std::deque<Event> _log;                         // 尚未被所有 follower 取走的事件
+    unsigned long long _head_seq{0};                // 最新事件序号
+    std::list<std::unique_ptr<Session>> _sessions;
+    unsigned long long _resyncs{0};                 // 因落后过多而重新同步的次数
+
+public:
+
+    ReplicationLeader(Skiplist<Key, Value, Traits>&, const std::string&);
+    ~ReplicationLeader();
+
+    bool start();
+    void stop();
+    unsigned long long head_seq();
+    unsigned long long lag();
+    size_t follower_count();
+    size_t log_size();
+    unsigned long long resyncs();
+
+private:
+
+    void append(Event&);
+    void accept_loop();
+    void serve(Session*);
+    void trim();
+    void drop_lagging();
+    void reap();
+    bool send_snapshot(Session*);
+    static void encode(std::string&, FrameType, const Event&);
+
+};
+
+
+template<typename Key, typename Value, typename Traits>
+ReplicationLeader<Key, Value, Traits>::ReplicationLeader(Skiplist<Key, Value, Traits> &list, const std::string &path) :
+    _list(list),
+    _path(path),
+    _listen_fd(-1) {}
+
+
+template<typename Key, typename Value, typename Traits>
+ReplicationLeader<Key, Value, Traits>::~ReplicationLeader() {
+    stop();
+}
+
+
+template<typename Key, typename Value, typename Traits>
+bool ReplicationLeader<Key, Value, Traits>::start() {
+
+    _listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (_listen_fd < 0) {
+        perror("socket");
+        return false;
+    }
+
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, _path.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(_path.c_str());
+
+    if (bind(_listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(_listen_fd, 16) != 0) {
+        perror("bind");
+        close(_listen_fd);
+        _listen_fd = -1;
+        return false;
+    }
+
+    _running.store(true);
+    _list.set_change_listener([this](Event &event) { append(event); });
+    _accept_thread = std::thread([this]() { accept_loop(); });
+    return true;
+}
+
+
+template<typename Key, typename Value, typename Traits>
+void ReplicationLeader<Key, Value, Traits>::stop() {
+
+    if (!_running.exchange(false)) {
+        return ;
+    }
+
+    _list.set_change_listener(nullptr);
+    _log_cv.notify_all();
+    if (_accept_thread.joinable()) {
+        _accept_thread.join();
+    }
+
+    for (auto &session : _sessions) {
+        shutdown(session -> fd, SHUT_RDWR);
+    }
+    _log_cv.notify_all();
+    for (auto &session : _sessions) {
+        if (session -> thread.joinable()) {
+            session -> thread.join();
+        }
+        close(session -> fd);
+    }
+    _sessions.clear();
+    _log.clear();
+
+    close(_listen_fd);
+    _listen_fd = -1;
+    unlink(_path.c_str());
+}
+
+
+template<typename Key, typename Value, typename Traits>
+unsigned long long ReplicationLeader<Key, Value, Traits>::head_seq() {
+    std::lock_guard<std::mutex> lock(_log_mtx);
+    return _head_seq;
+}
+
+
+/*
+* 最慢的 follower 落后的事件数，没有 follower 时为 0
+*/
+template<typename Key, typename Value, typename Traits>
+unsigned long long ReplicationLeader<Key, Value, Traits>::lag() {
+
+    std::lock_guard<std::mutex> lock(_log_mtx);
+    unsigned long long lag = 0;
+    for (auto &session : _sessions) {
+        if (session -> alive.load() && session -> ready) {
+            unsigned long long acked = session -> acked.load();
+            if (_head_seq > acked && _head_seq - acked > lag) {
+                lag = _head_seq - acked;
+            }
+        }
+    }
+    return lag;
+}
+
+
+template<typename Key, typename Value, typename Traits>
+size_t ReplicationLeader<Key, Value, Traits>::follower_count() {
+    std::lock_guard<std::mutex> lock(_log_mtx);
+    return _sessions.size();
+}
+
+
+template<typename Key, typename Value, typename Traits>
+size_t ReplicationLeader<Key, Value, Traits>::log_size() {
+    std::lock_guard<std::mutex> lock(_log_mtx);
+    return _log.size();
+}
+
+
+template<typename Key, typename Value, typename Traits>
+unsigned long long ReplicationLeader<Key, Value, Traits>::resyncs() {
+    std::lock_guard<std::mutex> lock(_log_mtx);
+    return _resyncs;
+}
+
+
+/*
+* Skiplist 的变更回调，写操作在表的写锁内调用，序号顺序即修改顺序
+*/
+template<typename Key, typename Value, typename Traits>
+void ReplicationLeader<Key, Value, Traits>::append(Event &event) {
+
+    {
+        std::lock_guard<std::mutex> lock(_log_mtx);
+        event.seq = ++ _head_seq;
+        // 没有 follower 时不保留日志，新 follower 总是从快照开始
+        if (!_sessions.empty()) {
+            _log.push_back(event);
+            if (_log.size() > REPL_MAX_LOG_EVENTS) {
+                drop_lagging();
+            }
+        }
+    }
+    _log_cv.notify_all();
+}
+
+
+/*
+* 日志超过上限时，已发送位置落后超过上限的会话改为等待重新同步，不再参与裁剪，需持有 _log_mtx
+*/
+template<typename Key, typename Value, typename Traits>
+void ReplicationLeader<Key, Value, Traits>::drop_lagging() {
+
+    for (auto &session : _sessions) {
+        if (session -> ready && _head_seq - session -> cursor > REPL_MAX_LOG_EVENTS) {
+            session -> ready = false;
+            session -> resync = true;
+            ++ _resyncs;
+        }
+    }
+    trim();
+}
+
+
+// 丢弃所有 follower 都已发送过的事件，需持有 _log_mtx
+template<typename Key, typename Value, typename Traits>
+void ReplicationLeader<Key, Value, Traits>::trim() {
+
+    unsigned long long min_cursor = ULLONG_MAX;
+    for (auto &session : _sessions) {
+        if (session -> alive.load() && session -> ready && session -> cursor < min_cursor) {
+            min_cursor = session -> cursor;
+        }
+    }
+    while (!_log.empty() && _log.front().seq <= min_cursor) {
+        _log.pop_front();
+    }
+}
+
+
+// 回收已断开的会话
+template<typename Key, typename Value, typename Traits>
+void ReplicationLeader<Key, Value, Traits>::reap() {
+
+    std::list<std::unique_ptr<Session>> dead;
+    {
+        std::lock_guard<std::mutex> lock(_log_mtx);
+        for (auto it = _sessions.begin(); it != _sessions.end(); ) {
+            if (!(*it) -> alive.load()) {
+                dead.push_back(std::move(*it));
+                it = _sessions.erase(it);
+            } else {
+                ++ it;
+            }
+        }
+        trim();
+    }
+    for (auto &session : dead) {
+        session -> thread.join();
+        close(session -> fd);
+    }
+}
+
+
+template<typename Key, typename Value, typename Traits>
+void ReplicationLeader<Key, Value, Traits>::accept_loop() {
+
+    while (_running.load()) {
+
+        reap();
+
+        pollfd pfd{_listen_fd, POLLIN, 0};
+        if (poll(&pfd, 1, REPL_HEARTBEAT_MS) <= 0) {
+            continue;
+        }
+
+        int fd = accept(_listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(_log_mtx);
+        _sessions.emplace_back(new Session());
+        Session *session = _sessions.back().get();
+        session -> fd = fd;
+        session -> thread = std::thread([this, session]() { serve(session); });
+    }
+}
+
+
+template<typename Key, typename Value, typename Traits>
+void ReplicationLeader<Key, Value, Traits>::encode(std::string &buf, FrameType type, const Event &event) {
+    size_t off = ReplCodec::begin_frame(buf, type);
+    ReplCodec::put_u64(buf, event.seq);
+    buf.push_back(static_cast<char>(event.op));
+    ReplCodec::put_u32(buf, static_cast<uint32_t>(event.ttl));
+    ReplCodec::put_u64(buf, static_cast<uint64_t>(event.deadline));
+    ReplCodec::put_str(buf, format_field(event.key));
+    ReplCodec::put_str(buf, format_field(event.end_key));
+    ReplCodec::put_str(buf, format_field(event.val));
+    ReplCodec::end_frame(buf, off);
+}
+
+
+/*
+* 发送一份完整快照，快照开始时的最新序号作为会话的发送位置
+*/
+template<typename Key, typename Value, typename Traits>
+bool ReplicationLeader<Key, Value, Traits>::send_snapshot(Session *session) {
+
+    // 快照先在读锁内拷贝出来，避免网络发送期间阻塞写操作
+    std::vector<std::tuple<Key, Value, time_t>> entries;
+    unsigned long long start = 0;
+    _list.snapshot([&]() {
+        std::lock_guard<std::mutex> lock(_log_mtx);
+        start = _head_seq;
+        session -> cursor = start;
+        session -> ready = true;
+        session -> resync = false;
+    }, [&](const Key &key, const Value &val, time_t deadline) {
+        entries.emplace_back(key, val, deadline);
+    });
+
+    std::string buf;
+    ReplCodec::end_frame(buf, ReplCodec::begin_frame(buf, FRAME_SNAPSHOT_BEGIN));
+    Event event{start, OP_INSERT, Key{}, Key{}, Value{}, -1};
+    bool ok = true;
+    for (auto &entry : entries) {
+        event.key = std::get<0>(entry);
+        event.val = std::get<1>(entry);
+        event.deadline = std::get<2>(entry);
+        encode(buf, FRAME_SNAPSHOT_ENTRY, event);
+        if (buf.size() >= REPL_FLUSH_BYTES) {
+            ok = ok && ReplCodec::send_all(session -> fd, buf);
+            buf.clear();
+        }
+    }
+    entries.clear();
+    entries.shrink_to_fit();
+    ReplCodec::put_seq_frame(buf, FRAME_SNAPSHOT_END, start);
+    return ok && ReplCodec::send_all(session -> fd, buf);
+}
+
+
+/*
+* 单个 follower 的发送流程：快照 -> 日志尾部 -> 持续推送，同时读取 follower 的确认；
+* 落后超过日志上限时重新发送快照
+*/
+template<typename Key, typename Value, typename Traits>
+void ReplicationLeader<Key, Value, Traits>::serve(Session *session) {
+
+    bool ok = send_snapshot(session);
+
+    std::string buf;
+    std::string ack_buf;
+    std::vector<Event> batch;
+    while (ok && _running.load()) {
+
+        unsigned long long head;
+        bool resync;
+        {
+            std::unique_lock<std::mutex> lock(_log_mtx);
+            _log_cv.wait_for(lock, std::chrono::milliseconds(REPL_HEARTBEAT_MS), [&]() {
+                return !_running.load() || _head_seq > session -> cursor;
+            });
+
+            resync = session -> resync;
+            batch.clear();
+            // 等待重新同步的会话不再读取日志，旧的发送位置可能已被裁掉
+            if (!resync && !_log.empty() && _head_seq > session -> cursor) {
+                size_t begin = session -> cursor + 1 > _log.front().seq ? session -> cursor + 1 - _log.front().seq : 0;
+                for (size_t i = begin; i < _log.size() && batch.size() < REPL_BATCH_SIZE; ++ i) {
+                    batch.push_back(_log[i]);
+                }
+                if (!batch.empty()) {
+                    session -> cursor = batch.back().seq;
+                }
+                trim();
+            }
+            head = _head_seq;
+        }
+
+        if (resync) {
+            ok = send_snapshot(session);
+            continue;
+        }
+
+        buf.clear();
+        for (const Event &e : batch) {
+            encode(buf, FRAME_EVENT, e);
+        }
+        ReplCodec::put_seq_frame(buf, FRAME_HEARTBEAT, head);
+        ok = ReplCodec::send_all(session -> fd, buf);
+
+        // 非阻塞读取确认帧
+        char tmp[4096];
+        ssize_t n;
+        while ((n = recv(session -> fd, tmp, sizeof(tmp), MSG_DONTWAIT)) > 0) {
+            ack_buf.append(tmp, n);
+        }
+        if (n == 0) {
+            ok = false;
+        }
+        while (ack_buf.size() >= 13) {
+            size_t pos = 5;
+            uint64_t seq;
+            ReplCodec::get_u64(ack_buf, &pos, &seq);
+            if (static_cast<unsigned char>(ack_buf[4]) == FRAME_ACK) {
+                session -> acked.store(seq);
+            }
+            ack_buf.erase(0, 13);
+        }
+    }
+
+    session -> alive.store(false);
+}
+
+
+
+template<typename Key, typename Value, typename Traits = DefaultSkiplistTraits>
+class ReplicationFollower {
+
+    typedef ChangeEvent<Key, Value> Event;
+
+    struct Item {
+        FrameType type;
+        Event event;
+    };
+
+private:
+
+    Skiplist<Key, Value, Traits> &_list;
+    std::string _path;
+    int _fd;
+
+    std::thread _recv_thread;
+    std::thread _apply_thread;
+    std::atomic<bool> _running{false};
+
+    std::mutex _queue_mtx;
+    std::condition_variable _queue_cv;
+    std::deque<Item> _queue;                          // 已接收、待应用的事件
+
+    std::atomic<unsigned long long> _applied_seq{0};
+    std::atomic<unsigned long long> _leader_seq{0};
+    std::atomic<unsigned long long> _applied_events{0};
+    std::atomic<bool> _caught_up{false};              // 快照是否已应用完成
+
+public:
+
+    ReplicationFollower(Skiplist<Key, Value, Traits>&, const std::string&);
+    ~ReplicationFollower();
+
+    bool start();
+    void stop();
+    bool caught_up() const;
+    unsigned long long applied_seq() const;
+    unsigned long long leader_seq() const;
+    unsigned long long lag() const;
+    unsigned long long applied_events() const;
+
+private:
+
+    void recv_loop();
+    void apply_loop();
+    void apply(const Item&);
+    void put(const Event&);
+    static bool decode(const std::string&, Event*);
+
+};
+
+
+template<typename Key, typename Value, typename Traits>
+ReplicationFollower<Key, Value, Traits>::ReplicationFollower(Skiplist<Key, Value, Traits> &list, const std::string &path) :
+    _list(list),
+    _path(path),
+    _fd(-1) {}
+
+
+template<typename Key, typename Value, typename Traits>
+ReplicationFollower<Key, Value, Traits>::~ReplicationFollower() {
+    stop();
+}
+
+
+template<typename Key, typename Value, typename Traits>
+bool ReplicationFollower<Key, Value, Traits>::start() {
+
+    _fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (_fd < 0) {
+        perror("socket");
+        return false;
+    }
+
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, _path.c_str(), sizeof(addr.sun_path) - 1);
+
+    if (connect(_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        perror("connect");
+        close(_fd);
+        _fd = -1;
+        return false;
+    }
+
+    _running.store(true);
+    _recv_thread = std::thread([this]() { recv_loop(); });
+    _apply_thread = std::thread([this]() { apply_loop(); });
+    return true;
+}
+
+
+template<typename Key, typename Value, typename Traits>
+void ReplicationFollower<Key, Value, Traits>::stop() {
+
+    if (!_running.exchange(false)) {
+        return ;
+    }
+    shutdown(_fd, SHUT_RDWR);
+    _queue_cv.notify_all();
+    if (_recv_thread.joinable()) {
+        _recv_thread.join();
+    }
+    if (_apply_thread.joinable()) {
+        _apply_thread.join();
+    }
+    close(_fd);
+    _fd = -1;
+}
+
+
+template<typename Key, typename Value, typename Traits>
+bool ReplicationFollower<Key, Value, Traits>::caught_up() const {
+    return _caught_up.load();
+}
+
+template<typename Key, typename Value, typename Traits>
+unsigned long long ReplicationFollower<Key, Value, Traits>::applied_seq() const {
+    return _applied_seq.load();
+}
+
+template<typename Key, typename Value, typename Traits>
+unsigned long long ReplicationFollower<Key, Value, Traits>::leader_seq() const {
+    return _leader_seq.load();
+}
+
+/*
+* 已知的 leader 最新序号与本地已应用序号之差
+*/
+template<typename Key, typename Value, typename Traits>
+unsigned long long ReplicationFollower<Key, Value, Traits>::lag() const {
+    unsigned long long leader = _leader_seq.load();
+    unsigned long long applied = _applied_seq.load();
+    return leader > applied ? leader - applied : 0;
+}
+
+template<typename Key, typename Value, typename Traits>
+unsigned long long ReplicationFollower<Key, Value, Traits>::applied_events() const {
+    return _applied_events.load();
+}
+
+
+template<typename Key, typename Value, typename Traits>
+bool ReplicationFollower<Key, Value, Traits>::decode(const std::string &payload, Event *event) {
+
+    size_t pos = 0;
+    uint64_t seq;
+    uint32_t ttl;
+    uint64_t deadline;
+    std::string key, end_key, val;
+    if (!ReplCodec::get_u64(payload, &pos, &seq) || pos >= payload.size()) {
+        return false;
+    }
+    event -> seq = seq;
+    event -> op = static_cast<ChangeOp>(static_cast<unsigned char>(payload[pos ++]));
+    if (!ReplCodec::get_u32(payload, &pos, &ttl) || !ReplCodec::get_u64(payload, &pos, &deadline) ||
+        !ReplCodec::get_str(payload, &pos, &key) ||
+        !ReplCodec::get_str(payload, &pos, &end_key) || !ReplCodec::get_str(payload, &pos, &val)) {
+        return false;
+    }
+    event -> ttl = static_cast<int>(ttl);
+    event -> deadline = static_cast<time_t>(deadline);
+    parse_field(key, &event -> key);
+    parse_field(end_key, &event -> end_key);
+    parse_field(val, &event -> val);
+    return true;
+}
+
+
+template<typename Key, typename Value, typename Traits>
+void ReplicationFollower<Key, Value, Traits>::recv_loop() {
+
+    FrameType type;
+    std::string payload;
+    std::vector<Item> pending;
+
+    while (_running.load() && ReplCodec::read_frame(_fd, &type, &payload)) {
+
+        Item item{type, Event{0, OP_INSERT, Key{}, Key{}, Value{}, -1}};
+        if (type == FRAME_EVENT || type == FRAME_SNAPSHOT_ENTRY) {
+            if (!decode(payload, &item.event)) {
+                break;
+            }
+        } else if (type == FRAME_SNAPSHOT_END || type == FRAME_HEARTBEAT) {
+            size_t pos = 0;
+            uint64_t seq = 0;
+            ReplCodec::get_u64(payload, &pos, &seq);
+            item.event.seq = seq;
+        }
+
+        if (item.event.seq > _leader_seq.load()) {
+            _leader_seq.store(item.event.seq);
+        }
+        if (type == FRAME_HEARTBEAT) {
+            // 心跳之前的事件一起交给应用线程
+            std::lock_guard<std::mutex> lock(_queue_mtx);
+            _queue.insert(_queue.end(), pending.begin(), pending.end());
+            pending.clear();
+            _queue_cv.notify_one();
+            continue;
+        }
+        pending.push_back(item);
+        if (pending.size() >= REPL_BATCH_SIZE) {
+            std::lock_guard<std::mutex> lock(_queue_mtx);
+            _queue.insert(_queue.end(), pending.begin(), pending.end());
+            pending.clear();
+            _queue_cv.notify_one();
+        }
+    }
+
+    _running.store(false);
+    _queue_cv.notify_all();
+}
+
+
+// 带过期时刻的条目以固定过期时刻写入，到期后 follower 本地读取即不可见
+template<typename Key, typename Value, typename Traits>
+void ReplicationFollower<Key, Value, Traits>::put(const Event &e) {
+    if constexpr (Traits::enable_ttl) {
+        if (e.deadline > 0) {
+            _list.insert_element_until(e.key, e.val, e.deadline);
+            return ;
+        }
+    }
+    if (_list.insert_element(e.key, e.val) != 0) {
+        _list.edit_elemnent(e.key, e.val);
+    }
+}
+
+
+template<typename Key, typename Value, typename Traits>
+void ReplicationFollower<Key, Value, Traits>::apply(const Item &item) {
+
+    const Event &e = item.event;
+
+    switch (item.type) {
+    case FRAME_SNAPSHOT_BEGIN:
+        _caught_up.store(false);
+        _list.clear();
+        return ;
+    case FRAME_SNAPSHOT_ENTRY:
+        put(e);
+        return ;
+    case FRAME_SNAPSHOT_END:
+        _applied_seq.store(e.seq);
+        _caught_up.store(true);
+        return ;
+    case FRAME_EVENT:
+        break;
+    default:
+        return ;
+    }
+
+    switch (e.op) {
+    case OP_INSERT:
+        put(e);
+        break;
+    case OP_EDIT:
+        _list.edit_elemnent(e.key, e.val);
+        break;
+    case OP_DELETE:
+    case OP_EXPIRE:
+        _list.delete_element(e.key);
+        break;
+    case OP_ERASE_RANGE:
+        _list.erase_range(e.key, e.end_key);
+        break;
+    case OP_TRUNCATE:
+        _list.split_at(e.key);
+        break;
+    case OP_CLEAR:
+        _list.clear();
+        break;
+    }
+    _applied_seq.store(e.seq);
+    _applied_events.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+template<typename Key, typename Value, typename Traits>
+void ReplicationFollower<Key, Value, Traits>::apply_loop() {
+
+    std::deque<Item> batch;
+    std::string ack;
+    unsigned long long acked = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(_queue_mtx);
+            _queue_cv.wait(lock, [this]() { return !_queue.empty() || !_running.load(); });
+            if (_queue.empty()) {
+                break;
+            }
+            batch.swap(_queue);
+        }
+
+        for (const Item &item : batch) {
+            apply(item);
+        }
+        batch.clear();
+
+        if (_applied_seq.load() != acked) {
+            acked = _applied_seq.load();
+            ack.clear();
+            ReplCodec::put_seq_frame(ack, FRAME_ACK, acked);
+            ReplCodec::send_all(_fd, ack);
+        }
+    }
+}
+
+#endif
@@ -1,3 +1,6 @@
+#ifndef SKIPLIST_H
+#define SKIPLIST_H
+
 #include <cmath>
 #include <cstdlib>
 #include <unordered_map>
@@ -16,133 +19,359 @@
 #include <mutex>
 #include <thread>
 #include <condition_variable>
+#include <functional>
+#include <type_traits>
+#include <algorithm>
+#include <sstream>
+#include <random>
+#include <cstdio>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
 
 #define STORE_FILE "store/dumpFile"   // 定义文件存储路径
+#define MANIFEST_SUFFIX ".manifest"   // 分段快照的清单文件后缀
+#define SEGMENT_SUFFIX ".seg"         // 分段快照的数据文件后缀
+#define SKIPLIST_MAX_LEVEL 63         // 运行期指定层数时的上限
 
 std::string delimiter = ":";          // 分隔符
 
 
-template <typename Key, typename Value>
+// 把 buf 全部写入 fd，被信号打断时继续写，失败返回 false
+inline bool snapshot_write_all(int fd, const std::string &buf) {
+    size_t done = 0;
+    while (done < buf.size()) {
+        ssize_t n = write(fd, buf.data() + done, buf.size() - done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            perror("write snapshot");
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+
+// fsync 文件所在目录，使目录中新建的文件和 rename 落盘
+inline bool snapshot_sync_dir(const std::string &path) {
+    size_t pos = path.rfind('/');
+    std::string dir = pos == std::string::npos ? "." : path.substr(0, pos);
+    int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        perror("open snapshot dir");
+        return false;
+    }
+    bool ok = fsync(fd) == 0;
+    if (!ok) {
+        perror("fsync snapshot dir");
+    }
+    close(fd);
+    return ok;
+}
+
+
+// 快照文件中的字段解析，std::string 原样保留（值中可能含空格）
+template<typename T>
+void parse_field(const std::string &str, T *out) {
+    std::istringstream in(str);
+    in >> *out;
+}
+
+inline void parse_field(const std::string &str, std::string *out) {
+    *out = str;
+}
+
+
+
+/*
+* Skiplist 的编译期策略，按需关闭不需要的功能：
+*   enable_ttl        节点是否携带生命周期
+*   enable_eviction   是否使用 LRUCache 管理定时节点（依赖 ttl 与 tombstone）
+*   enable_tombstone  删除时仅做标记，由 compact() 回收；关闭后删除即释放
+*   enable_stats      是否统计操作次数
+*   enable_background 是否启动后台 compact 线程（依赖 tombstone）
+*   enable_change_feed 是否支持变更订阅（用于复制）
+*   enable_adaptive_levels 是否按访问频率调整节点层数（热点 key 升高、冷 key 回落）
+*   max_level         大于 0 时为编译期固定层数，等于 0 时由构造函数指定
+*   compare           key 比较器，透明比较器（如 std::less<>）支持异构查找
+*   allocator_type    节点及 forward 数组的分配器
+*/
+struct DefaultSkiplistTraits {
+    static constexpr bool enable_ttl = true;
+    static constexpr bool enable_eviction = true;
+    static constexpr bool enable_tombstone = true;
+    static constexpr bool enable_stats = false;
+    static constexpr bool enable_background = true;
+    static constexpr bool enable_change_feed = true;
+    static constexpr bool enable_adaptive_levels = false;
+    static constexpr int max_level = 0;
+    typedef std::less<> compare;
+    typedef std::allocator<char> allocator_type;
+};
+
+
+// 普通有序表：不带 TTL、淘汰、墓碑和后台线程，层数固定
+struct OrderedMapTraits {
+    static constexpr bool enable_ttl = false;
+    static constexpr bool enable_eviction = false;
+    static constexpr bool enable_tombstone = false;
+    static constexpr bool enable_stats = false;
+    static constexpr bool enable_background = false;
+    static constexpr bool enable_change_feed = false;
+    static constexpr bool enable_adaptive_levels = false;
+    static constexpr int max_level = 16;
+    typedef std::less<> compare;
+    typedef std::allocator<char> allocator_type;
+};
+
+
+
+// 关闭的功能对应的空成员
+struct SkiplistEmpty {};
+
+
+template<bool>
+struct NodeTTL {
+    int _ttl{-1};
+    time_t _end_time{0};
+    bool timed{false};    // 标记是否为定时节点
+    bool fixed{false};    // 过期时刻固定，不随访问刷新（复制与日志重放写入的节点）
+};
+
+template<>
+struct NodeTTL<false> {};
+
+
+template<bool>
+struct NodeTombstone {
+    bool deleted{false};  // 标记节点是否被删除
+};
+
+template<>
+struct NodeTombstone<false> {};
+
+
+template<bool>
+struct NodeAccess {
+    std::atomic<unsigned> hits{0};  // 上次调整以来的访问次数（读锁下更新）
+    int base_level{0};              // 插入时随机得到的层数，冷却后回落到该层
+};
+
+template<>
+struct NodeAccess<false> {};
+
+
+// 变更类型，ERASE_RANGE 删除 [key, end_key)，TRUNCATE 删除不小于 key 的全部节点，CLEAR 清空
+enum ChangeOp {
+    OP_INSERT = 1,
+    OP_EDIT,
+    OP_DELETE,
+    OP_EXPIRE,
+    OP_ERASE_RANGE,
+    OP_TRUNCATE,
+    OP_CLEAR,
+};
+
+
+template<typename Key, typename Value>
+struct ChangeEvent {
+    unsigned long long seq;   // 由订阅方分配
+    ChangeOp op;
+    Key key;
+    Key end_key;
+    Value val;
+    int ttl;
+    time_t deadline{0};       // 绝对过期时刻，0 表示不过期
+};
+
+
+struct SkiplistStats {
+    std::atomic<unsigned long long> searches{0};
+    std::atomic<unsigned long long> hits{0};
+    std::atomic<unsigned long long> inserts{0};
+    std::atomic<unsigned long long> deletes{0};
+    std::atomic<unsigned long long> compactions{0};
+};
+
+
+
+template <typename Key, typename Value, typename Traits = DefaultSkiplistTraits>
 
-class Node {
+class Node : public NodeTTL<Traits::enable_ttl>, public NodeTombstone<Traits::enable_tombstone>,
+             public NodeAccess<Traits::enable_adaptive_levels> {
     
 private:
 
     Key _key;
     Value _val;
 
-    int _ttl;
-    time_t _end_time; 
-
 
 public:
 
-    // skiplist 节点指针数组，指向对应层次的后继节点
-    Node<Key, Value> **forward;
+    // skiplist 节点指针数组，指向对应层次的后继节点，由 Skiplist 的分配器分配
+    Node<Key, Value, Traits> **forward{nullptr};
     int node_level;
  
-    bool deleted{false};  // 标记节点是否被删除    
-    bool timed{false};    // 标记是否为定时节点
-    
- 
     Node(){};
     Node(const Key&, const Value&, int);
     Node(const Key&, const Value&, int, int);
-    ~Node();
     
-    Key get_key() const;
+    const Key &get_key() const;
     Value get_value() const;
     void set_value(const Value&);
 
 
     void mark_deleted();  // 设置删除标记
+    void revive(const Value&, int);  // 复用已删除的节点
+    bool is_deleted() const;
+    bool is_timed() const;
     bool is_timeout () const; 
+    bool is_timeout (time_t) const;  // 按给定时刻判断是否过期
     void set_end_time();  // 设置过期时间
+    void set_deadline(time_t);  // 设置固定的过期时刻
+    time_t get_end_time() const;  // 过期时刻，非定时节点返回 0
 
 };
 
 
-template<typename Key, typename Value>
-Node<Key, Value>::Node(const Key &key, const Value &val, int level, int ttl) : 
+template<typename Key, typename Value, typename Traits>
+Node<Key, Value, Traits>::Node(const Key &key, const Value &val, int level, int ttl) : 
     _key(key),
     _val(val),
-    node_level(level),
-    _ttl(ttl) {
-    
-    // level + 1, level if from [0, level].
-    forward = new Node<Key, Value> *[level + 1];
+    node_level(level) {
 
-    // 初始化为空指针
-    memset(forward, 0, sizeof(Node<Key, Value>*) * (level + 1));
+    if constexpr (Traits::enable_adaptive_levels) {
+        this -> base_level = level;
+    }
 
-    if(_ttl > 0) {
-        set_end_time();
-        timed = true;
+    if constexpr (Traits::enable_ttl) {
+        this -> _ttl = ttl;
+        if(ttl > 0) {
+            this -> timed = true;
+            set_end_time();
+        }
     }
 
 }
 
 
-template<typename Key, typename Value>
-Node<Key, Value>::Node(const Key &key, const Value &val, int level) : Node(key, val, level, -1) {}
+template<typename Key, typename Value, typename Traits>
+Node<Key, Value, Traits>::Node(const Key &key, const Value &val, int level) : Node(key, val, level, -1) {}
 
-template<typename Key, typename Value>
-Node<Key, Value>::~Node()
-{
-    delete[] forward;
-}
 
-template<typename Key, typename Value>
-Key Node<Key, Value>::get_key() const{
+template<typename Key, typename Value, typename Traits>
+const Key &Node<Key, Value, Traits>::get_key() const{
     return _key;
 }
 
-template<typename Key, typename Value>
-Value Node<Key, Value>::get_value() const{
+template<typename Key, typename Value, typename Traits>
+Value Node<Key, Value, Traits>::get_value() const{
     return _val;
 }
 
 
-template<typename Key, typename Value>
-void Node<Key, Value>::set_value(const Value &val){
+template<typename Key, typename Value, typename Traits>
+void Node<Key, Value, Traits>::set_value(const Value &val){
     _val = val;
 }
 
 
 
-template<typename Key, typename Value>
-void Node<Key, Value>::mark_deleted() {
-    deleted = true;
+template<typename Key, typename Value, typename Traits>
+void Node<Key, Value, Traits>::mark_deleted() {
+    static_assert(Traits::enable_tombstone, "mark_deleted requires enable_tombstone");
+    this -> deleted = true;
 }
 
-template<typename Key, typename Value>
-bool Node<Key, Value>::is_timeout() const {
-    return timed && (time(nullptr) > _end_time);
+template<typename Key, typename Value, typename Traits>
+void Node<Key, Value, Traits>::revive(const Value &val, int ttl) {
+    static_assert(Traits::enable_tombstone, "revive requires enable_tombstone");
+    _val = val;
+    this -> deleted = false;
+    if constexpr (Traits::enable_ttl) {
+        this -> _ttl = ttl;
+        this -> timed = ttl > 0;
+        this -> fixed = false;
+        set_end_time();
+    }
 }
 
-template<typename Key, typename Value>
-void Node<Key, Value>::set_end_time() {
-    if (timed) {
-        _end_time = time(nullptr) + _ttl;
+template<typename Key, typename Value, typename Traits>
+bool Node<Key, Value, Traits>::is_deleted() const {
+    if constexpr (Traits::enable_tombstone) {
+        return this -> deleted;
     }
-        
+    return false;
 }
 
+template<typename Key, typename Value, typename Traits>
+bool Node<Key, Value, Traits>::is_timed() const {
+    if constexpr (Traits::enable_ttl) {
+        return this -> timed;
+    }
+    return false;
+}
 
+template<typename Key, typename Value, typename Traits>
+bool Node<Key, Value, Traits>::is_timeout() const {
+    return is_timeout(time(nullptr));
+}
 
+template<typename Key, typename Value, typename Traits>
+bool Node<Key, Value, Traits>::is_timeout(time_t now) const {
+    if constexpr (Traits::enable_ttl) {
+        return this -> timed && (now > this -> _end_time);
+    }
+    return false;
+}
 
-template<typename Key, typename Value>
+template<typename Key, typename Value, typename Traits>
+void Node<Key, Value, Traits>::set_end_time() {
+    if constexpr (Traits::enable_ttl) {
+        if (this -> timed && !this -> fixed) {
+            this -> _end_time = time(nullptr) + this -> _ttl;
+        }
+    }
+}
+
+template<typename Key, typename Value, typename Traits>
+void Node<Key, Value, Traits>::set_deadline(time_t deadline) {
+    static_assert(Traits::enable_ttl, "set_deadline requires enable_ttl");
+    time_t now = time(nullptr);
+    this -> _ttl = deadline > now ? static_cast<int>(deadline - now) : 0;
+    this -> _end_time = deadline;
+    this -> timed = true;
+    this -> fixed = true;
+}
+
+template<typename Key, typename Value, typename Traits>
+time_t Node<Key, Value, Traits>::get_end_time() const {
+    if constexpr (Traits::enable_ttl) {
+        return this -> timed ? this -> _end_time : 0;
+    }
+    return 0;
+}
+
+
+
+
+template<typename Key, typename Value, typename Traits = DefaultSkiplistTraits>
 class LRUCache {
 
 private:
 
     size_t _capacity;
 
-    std::unordered_map<Key, typename std::list<Node<Key, Value>*>::iterator> _cache;
-    std::list<Node<Key, Value>*> _cache_list;
+    std::unordered_map<Key, typename std::list<Node<Key, Value, Traits>*>::iterator> _cache;
+    std::list<Node<Key, Value, Traits>*> _cache_list;
 
     std::mutex mtx;
 
+    std::function<void(Node<Key, Value, Traits>*)> _on_expire;  // 节点过期或被淘汰时回调
+
 public:
 
     LRUCache() : _capacity(-1) {}
@@ -155,10 +384,16 @@ public:
 
     void get(const Key& key);
 
-    void put(Node<Key, Value> *node);
+    void put(Node<Key, Value, Traits> *node);
 
     void remove(const Key &key);
 
+    void remove_node(Node<Key, Value, Traits> *node);  // 仅当 key 仍对应该节点时移除
+
+    void adopt(Node<Key, Value, Traits> *node);        // 接管其他缓存中的节点，不刷新过期时间
+
+    void set_expire_callback(std::function<void(Node<Key, Value, Traits>*)> cb);
+
     void clear() ;
 
     size_t size() const;
@@ -172,23 +407,35 @@ private:
 };
 
 
-template<typename Key, typename Value>
-void LRUCache<Key, Value>::get(const Key& key) {
+template<typename Key, typename Value, typename Traits>
+void LRUCache<Key, Value, Traits>::get(const Key& key) {
     
     std::lock_guard<std::mutex> lock(mtx);
     clean_expired();
     
-    if (_cache.find(key) != _cache.end()) {
-        auto iter = _cache[key];
+    auto found = _cache.find(key);
+    if (found != _cache.end()) {
+        auto iter = found -> second;
+        Node<Key, Value, Traits> *node = *iter;
+        // 不在队尾但已过期的节点不能被访问刷新
+        if (node -> is_timeout()) {
+            _cache.erase(found);
+            _cache_list.erase(iter);
+            node -> mark_deleted();
+            if (_on_expire) {
+                _on_expire(node);
+            }
+            return ;
+        }
         _cache_list.splice(_cache_list.begin(), _cache_list, iter);
-        (*iter) -> set_end_time();
+        node -> set_end_time();
     }
 
 }
 
 
-template<typename Key, typename Value>
-void LRUCache<Key, Value>::put(Node<Key, Value> *node) {
+template<typename Key, typename Value, typename Traits>
+void LRUCache<Key, Value, Traits>::put(Node<Key, Value, Traits> *node) {
     
     std::lock_guard<std::mutex> lock(mtx);
     clean_expired();
@@ -207,8 +454,8 @@ void LRUCache<Key, Value>::put(Node<Key, Value> *node) {
 
 
 
-template<typename Key, typename Value>
-void LRUCache<Key, Value>::remove(const Key &key) {
+template<typename Key, typename Value, typename Traits>
+void LRUCache<Key, Value, Traits>::remove(const Key &key) {
     
     std::lock_guard<std::mutex> lock(mtx);
     clean_expired();
@@ -220,33 +467,71 @@ void LRUCache<Key, Value>::remove(const Key &key) {
 }
 
 
-template<typename Key, typename Value>
-void LRUCache<Key, Value>::clear() {
+template<typename Key, typename Value, typename Traits>
+void LRUCache<Key, Value, Traits>::remove_node(Node<Key, Value, Traits> *node) {
+    
+    std::lock_guard<std::mutex> lock(mtx);
+    
+    auto iter = _cache.find(node -> get_key());
+    if (iter != _cache.end() && *(iter -> second) == node) {
+        _cache_list.erase(iter -> second);
+        _cache.erase(iter);
+    }
+}
+
+
+template<typename Key, typename Value, typename Traits>
+void LRUCache<Key, Value, Traits>::adopt(Node<Key, Value, Traits> *node) {
+    
+    std::lock_guard<std::mutex> lock(mtx);
+    const Key &key = node -> get_key();
+    
+    if (_cache.find(key) != _cache.end()) {
+        _cache_list.erase(_cache[key]);
+    }
+
+    _cache_list.push_front(node);
+    _cache[key] = _cache_list.begin();
+}
+
+
+template<typename Key, typename Value, typename Traits>
+void LRUCache<Key, Value, Traits>::set_expire_callback(std::function<void(Node<Key, Value, Traits>*)> cb) {
+    std::lock_guard<std::mutex> lock(mtx);
+    _on_expire = std::move(cb);
+}
+
+
+template<typename Key, typename Value, typename Traits>
+void LRUCache<Key, Value, Traits>::clear() {
     std::lock_guard<std::mutex> lock(mtx);
     _cache_list.clear();
     _cache.clear();
 }
 
 
-template<typename Key, typename Value>
-size_t LRUCache<Key, Value>::size() const {
+template<typename Key, typename Value, typename Traits>
+size_t LRUCache<Key, Value, Traits>::size() const {
     return _cache_list.size();
 }
 
 
-template<typename Key, typename Value>
-void LRUCache<Key, Value>::clean_expired() {
+template<typename Key, typename Value, typename Traits>
+void LRUCache<Key, Value, Traits>::clean_expired() {
         
     while (!_cache_list.empty()) {
         
         auto last_iter = std::prev(_cache_list.end());
-        Node<Key, Value>* node = *last_iter;
+        Node<Key, Value, Traits>* node = *last_iter;
 
         if (node -> is_timeout()) {
         
             _cache.erase(node -> get_key());
             _cache_list.erase(last_iter);
             node -> mark_deleted();
+            if (_on_expire) {
+                _on_expire(node);
+            }
         
         } else {
             break;
@@ -255,23 +540,61 @@ void LRUCache<Key, Value>::clean_expired() {
 }
 
 
-template<typename Key, typename Value>
-void LRUCache<Key, Value>::evict() {
+template<typename Key, typename Value, typename Traits>
+void LRUCache<Key, Value, Traits>::evict() {
 
     auto last_iter = std::prev(_cache_list.end());
-    Node<Key, Value>* node = *last_iter;
+    Node<Key, Value, Traits>* node = *last_iter;
     _cache.erase(node->get_key());
     _cache_list.erase(last_iter);
     node->mark_deleted();
+    if (_on_expire) {
+        _on_expire(node);
+    }
 
 }
 
 
 
-template<typename Key, typename Value>
+// 后台 compact 线程的状态，仅在 enable_background 时存在
+template<typename NodeType>
+struct SkiplistCompactor {
+    int interval_sec;                          // 定时 compact 的间隔（默认60秒）
+    std::thread thread;                        // 后台 compact 线程
+    std::atomic<bool> running{false};          // 控制线程启停
+    std::condition_variable_any cv;
+    std::mutex mtx;
+    std::vector<NodeType*> garbage;            // 待后台释放的节点链（沿 forward[0] 到空指针为止）
+};
+
+
+
+template<typename Key, typename Value, typename Traits = DefaultSkiplistTraits>
 class Skiplist{
 
+    static_assert(!Traits::enable_eviction || (Traits::enable_ttl && Traits::enable_tombstone),
+                  "enable_eviction requires enable_ttl and enable_tombstone");
+    static_assert(!Traits::enable_background || Traits::enable_tombstone,
+                  "enable_background requires enable_tombstone");
+    static_assert(Traits::max_level <= SKIPLIST_MAX_LEVEL, "max_level is too large");
+
+public:
+
+    typedef Node<Key, Value, Traits> node_type;
+    typedef typename Traits::compare key_compare;
+    typedef typename Traits::allocator_type allocator_type;
+    typedef std::function<void(ChangeEvent<Key, Value>&)> change_listener;
+
 private:
+
+    typedef typename std::allocator_traits<allocator_type>::template rebind_alloc<node_type> node_allocator;
+    typedef typename std::allocator_traits<allocator_type>::template rebind_alloc<node_type*> forward_allocator;
+    typedef std::allocator_traits<node_allocator> node_alloc_traits;
+    typedef std::allocator_traits<forward_allocator> forward_alloc_traits;
+
+    // update 数组放在栈上，容量取编译期层数或运行期上限
+    static constexpr int update_capacity = (Traits::max_level > 0 ? Traits::max_level : SKIPLIST_MAX_LEVEL) + 1;
+
     // maximum level of the skip list
     int _max_level;
     
@@ -279,7 +602,7 @@ private:
     int _skip_list_level;
     
     // pointer to header node 
-    Node<Key, Value> *_header;
+    node_type *_header;
     
     // current element count
     int _element_count;
@@ -288,78 +611,164 @@ private:
     std::ofstream _file_writer;
     std::ifstream _file_reader;
 
-    LRUCache<Key, Value> lru;
+    key_compare _compare;
+    node_allocator _node_alloc;
+    forward_allocator _forward_alloc;
+
+    std::conditional_t<Traits::enable_eviction, LRUCache<Key, Value, Traits>, SkiplistEmpty> lru;
     std::shared_mutex rw_mtx;
 
-    int _compact_interval_sec;                 // 定时 compact 的间隔（默认60秒）
-    std::thread _compact_thread;               // 后台 compact 线程
-    std::atomic<bool> _compact_running{false}; // 控制线程启停
-    std::condition_variable_any _compact_cv;
-    std::mutex _compact_mtx;
+    std::conditional_t<Traits::enable_background, SkiplistCompactor<node_type>, SkiplistEmpty> _compactor;
+    std::conditional_t<Traits::enable_stats, SkiplistStats, SkiplistEmpty> _stats;
+    std::conditional_t<Traits::enable_change_feed, change_listener, SkiplistEmpty> _listener;
+    std::conditional_t<Traits::enable_adaptive_levels, std::atomic<unsigned long long>, SkiplistEmpty> _access_total{};
+
 public:
     
+    Skiplist();
     Skiplist(int);
     Skiplist(int, int);
     ~Skiplist();
 
     int get_random_level();
+    int max_level() const;
     int insert_element(const Key&, const Value&);
     int insert_element(const Key&, const Value&, int);
+    int insert_element_until(const Key&, const Value&, time_t);
     bool search_element(const Key&);
+    bool search_element(const Key&, Value*);
     void delete_element(const Key&);
     int edit_elemnent(const Key&, const Value&);
+
+    // 透明比较器下的异构查找，例如用 std::string_view 查找 std::string key
+    template<typename K, typename C = key_compare, typename = typename C::is_transparent>
+    bool search_element(const K &key) { return search_impl(key, nullptr); }
+    template<typename K, typename C = key_compare, typename = typename C::is_transparent>
+    void delete_element(const K &key) { delete_impl(key); }
+    template<typename K, typename C = key_compare, typename = typename C::is_transparent>
+    int edit_elemnent(const K &key, const Value &val) { return edit_impl(key, val); }
+
     void display_list();
     void clear();
     void dump_file();
     void load_file();
+    int dump_file_parallel(int);
+    int load_file_parallel();
     int size() const;
+    void compact();
+    void rebalance_levels();
     void stop_compact_scheduler();
+    const SkiplistStats &stats() const;
+
+    // 结构性操作：只切断、重连各层指针，被删除的节点交给后台线程释放
+    std::unique_ptr<Skiplist> split_at(const Key&);
+    void merge(Skiplist&);
+    void erase_range(const Key&, const Key&);
+
+    // 变更订阅：回调在写锁内按修改顺序调用（过期事件可能在读锁内触发），回调中不能再访问本表
+    void set_change_listener(change_listener);
+    // 在读锁内先调用 begin()，再按 key 顺序对每个有效节点调用 f(key, value)，
+    // f 接受第三个参数时同时传入过期时刻（非定时节点为 0）
+    template<typename Begin, typename F> void snapshot(Begin, F);
+    // 在读锁内按 key 顺序对 [lo, hi) 内的每个有效节点调用 f(key, value)
+    template<typename F> void scan(const Key&, const Key&, F);
 
 private:
-    Node<Key, Value> *create_node(const Key&, const Value&, int);
-    Node<Key, Value> *create_node(const Key&, const Value&, int, int);
+
+    // 并行加载时每个线程独立构建的有序链，最后按顺序拼接
+    struct Segment {
+        std::vector<node_type*> head;
+        std::vector<node_type*> tail;
+        int level{0};
+        int count{0};
+        bool ordered{true};
+    };
+
+    node_type *create_node(const Key&, const Value&, int);
+    node_type *create_node(const Key&, const Value&, int, int);
+    void destroy_node(node_type*);
+    void unlink_node(node_type*, node_type**);
+    void shrink_level();
+    node_type *last_nodes(node_type**);
+    void detach_levels_above(int);
+    void defer_free(node_type*);
+    void reclaim(std::vector<node_type*>&);
+    void emit(ChangeOp, const Key&, const Value&, int, time_t);
+    void emit(ChangeOp, const Key&, const Key&);
+    void emit_chain(node_type*);
+    template<typename K> node_type *find_greater_or_equal(const K&, node_type**);
+    template<typename K> node_type *find_early(const K&);
+    template<typename K> bool search_impl(const K&, Value*);
+    template<typename K> void delete_impl(const K&);
+    template<typename K> int edit_impl(const K&, const Value&);
     void get_key_value_from_string(const std::string& str, std::string *key, std::string *val);
     bool is_valid_string(const std::string& str);
-    void compact();
+    int random_level(std::minstd_rand&) const;
+    int dump_segment(const std::string&, node_type*, node_type*);
+    bool load_segment(const std::string&, Segment*);
+    bool read_manifest(std::vector<std::string>*, std::vector<int>*, unsigned long long*);
     void start_compact_scheduler();
 
 };
 
-template<typename Key, typename Value>
-Node<Key, Value>* Skiplist<Key, Value>::create_node(const Key& key, const Value& val, int level){
-    Node<Key, Value>* node = new Node<Key, Value>(key, val, level);  
-    return node;
+template<typename Key, typename Value, typename Traits>
+Node<Key, Value, Traits>* Skiplist<Key, Value, Traits>::create_node(const Key& key, const Value& val, int level){
+    return create_node(key, val, level, -1);
 }
 
 
-template<typename Key, typename Value>
-Node<Key, Value>* Skiplist<Key, Value>::create_node(const Key& key, const Value& val, int level, int ttl){
-    Node<Key, Value>* node = new Node<Key, Value>(key, val, level, ttl);  
+template<typename Key, typename Value, typename Traits>
+Node<Key, Value, Traits>* Skiplist<Key, Value, Traits>::create_node(const Key& key, const Value& val, int level, int ttl){
+    node_type *node = node_alloc_traits::allocate(_node_alloc, 1);
+    node_alloc_traits::construct(_node_alloc, node, key, val, level, ttl);
+
+    // level + 1, level if from [0, level].
+    node -> forward = forward_alloc_traits::allocate(_forward_alloc, level + 1);
+
+    // 初始化为空指针
+    memset(node -> forward, 0, sizeof(node_type*) * (level + 1));
     return node;
 }
 
 
+template<typename Key, typename Value, typename Traits>
+void Skiplist<Key, Value, Traits>::destroy_node(node_type *node){
+    forward_alloc_traits::deallocate(_forward_alloc, node -> forward, node -> node_level + 1);
+    node_alloc_traits::destroy(_node_alloc, node);
+    node_alloc_traits::deallocate(_node_alloc, node, 1);
+}
+
+
 
-template<typename Key, typename Value>
-int Skiplist<Key, Value>::get_random_level(){
+template<typename Key, typename Value, typename Traits>
+int Skiplist<Key, Value, Traits>::get_random_level(){
     int k = 1;
     while(rand() % 2 == 1){
         ++ k;
     }
-    k = (k < _max_level) ? k : _max_level;
+    k = (k < max_level()) ? k : max_level();
     return k;
 }
 
 
-template <typename Key, typename Value>
-void Skiplist<Key, Value>::clear(){
+template<typename Key, typename Value, typename Traits>
+int Skiplist<Key, Value, Traits>::max_level() const {
+    if constexpr (Traits::max_level > 0) {
+        return Traits::max_level;
+    }
+    return _max_level;
+}
+
+
+template <typename Key, typename Value, typename Traits>
+void Skiplist<Key, Value, Traits>::clear(){
 
     std::unique_lock<std::shared_mutex> lock(rw_mtx);
 
-    Node<Key, Value>* current = _header -> forward[0];
+    node_type* current = _header -> forward[0];
     while(current){
-        Node<Key, Value>* tmp = current -> forward[0];
-        delete current;
+        node_type* tmp = current -> forward[0];
+        destroy_node(current);
         current = tmp;
     }
     for(int i = 0; i <= this -> _skip_list_level; ++ i){
@@ -367,222 +776,470 @@ void Skiplist<Key, Value>::clear(){
     }
     _skip_list_level = 0;
     _element_count = 0;
-    lru.clear();
+    emit(OP_CLEAR, Key{}, Key{});
+    if constexpr (Traits::enable_eviction) {
+        lru.clear();
+    }
 }
 
 
 
-template<typename Key, typename Value>
-Skiplist<Key, Value>::Skiplist(const int max_level) : Skiplist(max_level, 5) {}
+template<typename Key, typename Value, typename Traits>
+Skiplist<Key, Value, Traits>::Skiplist() : Skiplist(Traits::max_level) {
+    static_assert(Traits::max_level > 0, "Skiplist() requires a compile-time max_level");
+}
 
-template<typename Key, typename Value>
-Skiplist<Key, Value>::Skiplist(const int max_level, const int compact_interval_sec) : _max_level(max_level), _compact_interval_sec(compact_interval_sec) {
+template<typename Key, typename Value, typename Traits>
+Skiplist<Key, Value, Traits>::Skiplist(const int max_level) : Skiplist(max_level, 5) {}
 
-    Key key;
-    Value val;
-    _header = create_node(key, val, max_level);
+/*
+* max_level: 运行期层数，Traits::max_level 大于 0 时以编译期层数为准
+* compact_interval_sec: 后台 compact 间隔，未启用后台线程时忽略
+*/
+template<typename Key, typename Value, typename Traits>
+Skiplist<Key, Value, Traits>::Skiplist(const int max_level, const int compact_interval_sec) :
+    _max_level(Traits::max_level > 0 ? Traits::max_level : std::min(max_level, SKIPLIST_MAX_LEVEL)) {
+
+    Key key{};
+    Value val{};
+    _header = create_node(key, val, _max_level);
     _element_count = 0;
     _skip_list_level = 0;
-    start_compact_scheduler(); // 启动定时线程
+
+    if constexpr (Traits::enable_background) {
+        _compactor.interval_sec = compact_interval_sec;
+        start_compact_scheduler(); // 启动定时线程
+    }
 
 }
 
 
-template <typename key, typename value>
-Skiplist<key, value>::~Skiplist()
+template <typename key, typename value, typename Traits>
+Skiplist<key, value, Traits>::~Skiplist()
 {
-    std::cout << "~~~~~" << std::endl;
-    stop_compact_scheduler(); // 停止定时线程
+    if constexpr (Traits::enable_background) {
+        std::cout << "~~~~~" << std::endl;
+        stop_compact_scheduler(); // 停止定时线程
+        reclaim(_compactor.garbage);
+    }
     if (_file_writer.is_open()) {
         _file_writer.close();
     }
     if (_file_reader.is_open()) {
         _file_reader.close();
     }
+    // 析构不是数据变更，不通知订阅方
+    if constexpr (Traits::enable_change_feed) {
+        _listener = nullptr;
+    }
     clear();
-    delete _header;
+    destroy_node(_header);
 }
 
 
 
-template <typename Key, typename Value>
-bool Skiplist<Key, Value>::search_element(const Key& key){
-
-    Node<Key, Value> *current = nullptr;
-
-    std::shared_lock<std::shared_mutex> lock(rw_mtx);
+/*
+* 返回第一个 key 不小于给定值的节点，update 非空时记录每层的前驱
+*/
+template<typename Key, typename Value, typename Traits>
+template<typename K>
+Node<Key, Value, Traits>* Skiplist<Key, Value, Traits>::find_greater_or_equal(const K &key, node_type **update){
 
-    current = _header;
-    for(int i = _skip_list_level; i >=0; -- i){
-        while(current -> forward[i] != nullptr && current -> forward[i] -> get_key() < key){
+    node_type *current = _header;
+    for(int i = _skip_list_level; i >= 0; -- i){
+        while(current -> forward[i] != nullptr && _compare(current -> forward[i] -> get_key(), key)){
             current = current -> forward[i];
         }
+        if (update) {
+            update[i] = current;
+        }
     }
-    current = current -> forward[0];
-    
-    while(current && current -> deleted) {
-        current = current -> forward[0];
-    }
-
-    if (current && current -> timed == true) {
-        lru.get(key);
-    }
-
-    return current && current -> get_key() == key;
+    return current -> forward[0];
 }
 
 
-template<typename Key, typename Value>
-int Skiplist<Key, Value>::edit_elemnent(const Key& key, const Value &val) {
+/*
+* 与 find_greater_or_equal 相同，但在任意一层遇到相等的 key 即返回，
+* 被提升到高层的热点 key 不必下降到第 0 层
+*/
+template<typename Key, typename Value, typename Traits>
+template<typename K>
+Node<Key, Value, Traits>* Skiplist<Key, Value, Traits>::find_early(const K &key){
 
+    node_type *current = _header;
+    for(int i = _skip_list_level; i >= 0; -- i){
+        while(current -> forward[i] != nullptr && _compare(current -> forward[i] -> get_key(), key)){
+            current = current -> forward[i];
+        }
+        if (current -> forward[i] != nullptr && !_compare(key, current -> forward[i] -> get_key())) {
+            return current -> forward[i];
+        }
+    }
+    return current -> forward[0];
+}
 
-    Node<Key, Value> *current = nullptr;
 
-    std::unique_lock<std::shared_mutex> lock(rw_mtx);
+/*
+* 将节点从所有层摘除，update 为 find_greater_or_equal 得到的前驱
+*/
+template<typename Key, typename Value, typename Traits>
+void Skiplist<Key, Value, Traits>::unlink_node(node_type *node, node_type **update){
 
-    current = _header;
-    for(int i = _skip_list_level; i >=0; -- i){
-        while(current -> forward[i] != nullptr && current -> forward[i] -> get_key() < key){
-            current = current -> forward[i];
+    for(int i = 0; i <= node -> node_level && i <= _skip_list_level; ++ i){
+        if (update[i] -> forward[i] == node) {
+            update[i] -> forward[i] = node -> forward[i];
         }
     }
-    current = current -> forward[0];
-    while(current && current -> deleted) {
-        current = current -> forward[0];
-    }
+    shrink_level();
+}
 
-    if(current == nullptr || current -> get_key() != key) {
-        return 0;
-    }
 
-    if (current && current -> get_key() == key){
-        current -> set_value(val);
+template<typename Key, typename Value, typename Traits>
+void Skiplist<Key, Value, Traits>::shrink_level(){
+    while( _skip_list_level > 0 && _header -> forward[_skip_list_level] == nullptr) {
+        -- _skip_list_level;
     }
+}
 
 
-    if (current -> timed) {
-        lru.get(key);
-    }
 
-    return 1;
+template <typename Key, typename Value, typename Traits>
+bool Skiplist<Key, Value, Traits>::search_element(const Key& key){
+    return search_impl(key, nullptr);
 }
 
-template<typename Key, typename Value>
-int Skiplist<Key, Value>::insert_element(const Key& key, const Value &val){
-    
-    return insert_element(key, val, -1);
 
+// 找到时通过 val 带回当前值
+template <typename Key, typename Value, typename Traits>
+bool Skiplist<Key, Value, Traits>::search_element(const Key& key, Value *val){
+    return search_impl(key, val);
 }
 
 
-template<typename Key, typename Value>
-int Skiplist<Key, Value>::insert_element(const Key& key, const Value &val, int ttl){
-    
-    Node<Key, Value> *node = nullptr;
+template <typename Key, typename Value, typename Traits>
+template <typename K>
+bool Skiplist<Key, Value, Traits>::search_impl(const K& key, Value *val){
 
-    std::unique_lock<std::shared_mutex> lock(rw_mtx);
-    Node<Key, Value> *current = this -> _header;
-    Node<Key, Value> **update = new Node<Key, Value> *[this -> _max_level + 1];
+    std::shared_lock<std::shared_mutex> lock(rw_mtx);
 
-    memset(update, 0, sizeof(Node<Key, Value>*) * (this -> _max_level + 1));
+    node_type *current;
+    if constexpr (Traits::enable_adaptive_levels) {
+        current = find_early(key);
+    } else {
+        current = find_greater_or_equal(key, nullptr);
+    }
+    
+    while(current && current -> is_deleted()) {
+        current = current -> forward[0];
+    }
 
-    for(int i = _skip_list_level; i >= 0; -- i){
-        while(current -> forward[i] != nullptr && current -> forward[i] -> get_key() < key){
-            current = current -> forward[i];
+    bool found = current && !_compare(key, current -> get_key());
+
+    if constexpr (Traits::enable_ttl) {
+        if (found && current -> is_timed()) {
+            if constexpr (Traits::enable_eviction) {
+                lru.get(current -> get_key());
+            }
+            // 未过期的节点已被 lru.get 刷新，仍然过期的不可见
+            found = !current -> is_timeout();
         }
-        update[i] = current;
     }
 
-    current = current -> forward[0];
-    if(current != nullptr && current -> get_key() == key){
-        std::cout << "Key: " << key << ", exists. \n";
-        return 1;
+    if constexpr (Traits::enable_adaptive_levels) {
+        if (found) {
+            current -> hits.fetch_add(1, std::memory_order_relaxed);
+            _access_total.fetch_add(1, std::memory_order_relaxed);
+        }
     }
 
-    int random_level = get_random_level();
-    if(random_level > _skip_list_level){
-        for(int i = _skip_list_level + 1; i <= random_level; ++ i){
-            update[i] =  _header;
+    if constexpr (Traits::enable_stats) {
+        _stats.searches.fetch_add(1, std::memory_order_relaxed);
+        if (found) {
+            _stats.hits.fetch_add(1, std::memory_order_relaxed);
         }
-        _skip_list_level = random_level;
     }
 
-    node = create_node(key, val, random_level, ttl);
-    for(int i = 0; i <= random_level; ++ i){
-        node -> forward[i] = update[i] -> forward[i];
-        update[i] -> forward[i] = node;
+    if (found && val) {
+        *val = current -> get_value();
     }
 
-    delete[] update;
-
-    ++ _element_count;
-    
+    return found;
+}
 
-    if (node->timed) {
-        lru.put(node);  
-    }
 
-    return 0;
+template<typename Key, typename Value, typename Traits>
+int Skiplist<Key, Value, Traits>::edit_elemnent(const Key& key, const Value &val) {
+    return edit_impl(key, val);
 }
 
 
+template<typename Key, typename Value, typename Traits>
+template<typename K>
+int Skiplist<Key, Value, Traits>::edit_impl(const K& key, const Value &val) {
 
-/* 
-* 根据key值，惰性删除节点
-* @param key: 待删除节点的key值
-*/
-template<typename Key, typename Value>
-void Skiplist<Key, Value>::delete_element(const Key& key){
-    
     std::unique_lock<std::shared_mutex> lock(rw_mtx);
-    Node<Key, Value>* current = _header;
+
+    node_type *current = find_greater_or_equal(key, nullptr);
+    while(current && current -> is_deleted()) {
+        current = current -> forward[0];
+    }
+
+    if(current == nullptr || _compare(key, current -> get_key()) || current -> is_timeout()) {
+        return 0;
+    }
+
+    current -> set_value(val);
+    emit(OP_EDIT, current -> get_key(), val, -1, 0);
+
+    if constexpr (Traits::enable_ttl) {
+        if (current -> is_timed()) {
+            if constexpr (Traits::enable_eviction) {
+                lru.get(current -> get_key());
+            } else {
+                current -> set_end_time();
+            }
+        }
+    }
+
+    return 1;
+}
+
+template<typename Key, typename Value, typename Traits>
+int Skiplist<Key, Value, Traits>::insert_element(const Key& key, const Value &val){
     
-    for(int i = this -> _skip_list_level; i >= 0; -- i){
-        while(current -> forward[i] != nullptr && current -> forward[i] -> get_key() < key){
-            current = current -> forward[i];
+    return insert_element(key, val, -1);
+
+}
+
+
+template<typename Key, typename Value, typename Traits>
+int Skiplist<Key, Value, Traits>::insert_element(const Key& key, const Value &val, int ttl){
+    
+    std::unique_lock<std::shared_mutex> lock(rw_mtx);
+
+    node_type *update[update_capacity];
+    node_type *current = find_greater_or_equal(key, update);
+
+    if(current != nullptr && !_compare(key, current -> get_key())){
+        if constexpr (Traits::enable_ttl && !Traits::enable_eviction) {
+            // 没有 LRU 时过期节点在这里回收，让出 key
+            if (current -> is_timeout()) {
+                emit(OP_EXPIRE, current -> get_key(), current -> get_key());
+                unlink_node(current, update);
+                destroy_node(current);
+                -- _element_count;
+                current = find_greater_or_equal(key, update);
+            }
+        }
+        if (current != nullptr && !_compare(key, current -> get_key())) {
+            if constexpr (Traits::enable_tombstone) {
+                // 已标记删除但尚未 compact 的同 key 节点直接复用
+                if (current -> is_deleted()) {
+                    current -> revive(val, ttl);
+                    if constexpr (Traits::enable_eviction) {
+                        if (current -> is_timed()) {
+                            lru.put(current);
+                        }
+                    }
+                    emit(OP_INSERT, key, val, ttl, current -> get_end_time());
+                    return 0;
+                }
+            }
+            std::cout << "Key: " << key << ", exists. \n";
+            return 1;
         }
     }
+
+    int random_level = get_random_level();
+    if(random_level > _skip_list_level){
+        for(int i = _skip_list_level + 1; i <= random_level; ++ i){
+            update[i] =  _header;
+        }
+        _skip_list_level = random_level;
+    }
+
+    node_type *node = create_node(key, val, random_level, ttl);
+    for(int i = 0; i <= random_level; ++ i){
+        node -> forward[i] = update[i] -> forward[i];
+        update[i] -> forward[i] = node;
+    }
+
+    ++ _element_count;
     
-    current = current -> forward[0];
-    while (current && current -> deleted) {  // 跳过已标记删除的节点
-        current = current -> forward[0];
+    if constexpr (Traits::enable_eviction) {
+        if (node -> is_timed()) {
+            lru.put(node);  
+        }
     }
 
-    if(current != nullptr && current -> get_key() == key) {
-        
+    if constexpr (Traits::enable_stats) {
+        _stats.inserts.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    emit(OP_INSERT, key, val, ttl, node -> get_end_time());
+
+    return 0;
+}
+
+
+/*
+* 插入在绝对时刻 deadline 过期的节点，过期时刻不随访问刷新，用于复制和日志重放。
+* key 已存在（含已删除未回收的节点）时更新值和过期时刻，返回 1；新插入返回 0；
+* key 不存在且 deadline 已过时不插入，返回 -1
+*/
+template<typename Key, typename Value, typename Traits>
+int Skiplist<Key, Value, Traits>::insert_element_until(const Key& key, const Value &val, time_t deadline){
+
+    static_assert(Traits::enable_ttl, "insert_element_until requires enable_ttl");
+
+    std::unique_lock<std::shared_mutex> lock(rw_mtx);
+
+    node_type *update[update_capacity];
+    node_type *current = find_greater_or_equal(key, update);
+
+    if (current != nullptr && !_compare(key, current -> get_key())) {
+        if constexpr (Traits::enable_tombstone) {
+            if (current -> is_deleted()) {
+                current -> revive(val, -1);
+            }
+        }
+        current -> set_value(val);
+        current -> set_deadline(deadline);
+        if constexpr (Traits::enable_eviction) {
+            lru.put(current);
+        }
+        emit(OP_INSERT, key, val, -1, deadline);
+        return 1;
+    }
+
+    if (time(nullptr) > deadline) {
+        return -1;
+    }
+
+    int random_level = get_random_level();
+    if(random_level > _skip_list_level){
+        for(int i = _skip_list_level + 1; i <= random_level; ++ i){
+            update[i] =  _header;
+        }
+        _skip_list_level = random_level;
+    }
+
+    node_type *node = create_node(key, val, random_level, -1);
+    node -> set_deadline(deadline);
+    for(int i = 0; i <= random_level; ++ i){
+        node -> forward[i] = update[i] -> forward[i];
+        update[i] -> forward[i] = node;
+    }
+
+    ++ _element_count;
+
+    if constexpr (Traits::enable_eviction) {
+        lru.put(node);
+    }
+
+    if constexpr (Traits::enable_stats) {
+        _stats.inserts.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    emit(OP_INSERT, key, val, -1, deadline);
+
+    return 0;
+}
+
+
+
+template<typename Key, typename Value, typename Traits>
+void Skiplist<Key, Value, Traits>::delete_element(const Key& key){
+    delete_impl(key);
+}
+
+
+/* 
+* 根据key值删除节点：启用墓碑时惰性删除，否则立即摘除并释放
+* @param key: 待删除节点的key值
+*/
+template<typename Key, typename Value, typename Traits>
+template<typename K>
+void Skiplist<Key, Value, Traits>::delete_impl(const K& key){
+    
+    std::unique_lock<std::shared_mutex> lock(rw_mtx);
+
+    if constexpr (Traits::enable_tombstone) {
+
+        node_type *current = find_greater_or_equal(key, nullptr);
+        while (current && current -> is_deleted()) {  // 跳过已标记删除的节点
+            current = current -> forward[0];
+        }
+
+        if(current == nullptr || _compare(key, current -> get_key())) {
+            return ;
+        }
+
         current -> mark_deleted();
-        if (current -> timed) {
-            lru.remove(key);
+        if constexpr (Traits::enable_eviction) {
+            if (current -> is_timed()) {
+                lru.remove(current -> get_key());
+            }
+        }
+        emit(OP_DELETE, current -> get_key(), current -> get_key());
+
+    } else {
+
+        node_type *update[update_capacity];
+        node_type *current = find_greater_or_equal(key, update);
+
+        if(current == nullptr || _compare(key, current -> get_key())) {
+            return ;
         }
+
+        emit(OP_DELETE, current -> get_key(), current -> get_key());
+        unlink_node(current, update);
+        destroy_node(current);
+        -- _element_count;
     }
 
-    return ;
+    if constexpr (Traits::enable_stats) {
+        _stats.deletes.fetch_add(1, std::memory_order_relaxed);
+    }
 }
 
 
 int cnt = 0;
-template<typename Key, typename Value>
-void Skiplist<Key, Value>::compact() {
+template<typename Key, typename Value, typename Traits>
+void Skiplist<Key, Value, Traits>::compact() {
+
+    if constexpr (!Traits::enable_tombstone) {
+        return ;
+    }
     
     std::unique_lock<std::shared_mutex> lock(rw_mtx);
+
+    // 各层使用同一时刻判断过期，否则节点可能在上层保留、却在第 0 层被释放
+    time_t now = time(nullptr);
     
     // 最底层直接删除节点，其他层将指针跳过节点
     for (int i = _skip_list_level; i >= 0; -- i) {
         
-        Node<Key, Value>* current = _header->forward[i];
-        Node<Key, Value>* prev = _header;
+        node_type* current = _header->forward[i];
+        node_type* prev = _header;
 
         while(current) {
 
-            if(current -> deleted) {
+            // 没有 LRU 管理时，过期节点也在这里回收
+            bool expired = !Traits::enable_eviction && current -> is_timeout(now);
+
+            if(current -> is_deleted() || expired) {
 
                 prev -> forward[i] = current -> forward[i];
 
                 if( i == 0) {
                     
-                    Node<Key, Value> *tmp = current;
+                    node_type *tmp = current;
                     current = current -> forward[i];
-                    delete tmp;
+                    if (expired && !tmp -> is_deleted()) {
+                        emit(OP_EXPIRE, tmp -> get_key(), tmp -> get_key());
+                    }
+                    destroy_node(tmp);
                     -- _element_count;
                 
                 } else {
@@ -602,6 +1259,10 @@ void Skiplist<Key, Value>::compact() {
         -- _skip_list_level;
     }
 
+    if constexpr (Traits::enable_stats) {
+        _stats.compactions.fetch_add(1, std::memory_order_relaxed);
+    }
+
     std::cout << "in compact: " << ++cnt << std::endl;
 
 }
@@ -609,22 +1270,532 @@ void Skiplist<Key, Value>::compact() {
 
 
 
-template<typename Key, typename Value>
-int Skiplist<Key, Value>::size() const {
+/*
+* 记录每层的最后一个节点（没有节点的层为头节点），返回第 0 层的最后一个节点
+*/
+template<typename Key, typename Value, typename Traits>
+Node<Key, Value, Traits>* Skiplist<Key, Value, Traits>::last_nodes(node_type **tails){
+
+    node_type *current = _header;
+    for(int i = max_level(); i >= 0; -- i){
+        if (i <= _skip_list_level) {
+            while(current -> forward[i] != nullptr){
+                current = current -> forward[i];
+            }
+        }
+        tails[i] = current;
+    }
+    return tails[0];
+}
+
+
+/*
+* 断开 level 以上各层的链接，用于把层数更高的表并入本表
+*/
+template<typename Key, typename Value, typename Traits>
+void Skiplist<Key, Value, Traits>::detach_levels_above(int level){
+
+    for(int i = _skip_list_level; i > level; -- i){
+        node_type *current = _header -> forward[i];
+        while(current != nullptr){
+            node_type *next = current -> forward[i];
+            current -> forward[i] = nullptr;
+            current = next;
+        }
+        _header -> forward[i] = nullptr;
+    }
+    if (_skip_list_level > level) {
+        _skip_list_level = level;
+    }
+}
+
+
+/*
+* 释放从 head 开始的节点链：启用后台线程时交给 compact 线程，否则在调用线程中释放。
+* 调用前节点已不计入 _element_count，也已移出 LRU，这里只负责销毁
+*/
+template<typename Key, typename Value, typename Traits>
+void Skiplist<Key, Value, Traits>::defer_free(node_type *head){
+
+    if (head == nullptr) {
+        return ;
+    }
+
+    if constexpr (Traits::enable_background) {
+        {
+            std::lock_guard<std::mutex> lk(_compactor.mtx);
+            _compactor.garbage.push_back(head);
+        }
+        _compactor.cv.notify_all();
+    } else {
+        std::vector<node_type*> batch{head};
+        reclaim(batch);
+    }
+}
+
+
+template<typename Key, typename Value, typename Traits>
+void Skiplist<Key, Value, Traits>::reclaim(std::vector<node_type*> &batch){
+
+    for (node_type *node : batch) {
+        while (node != nullptr) {
+            node_type *next = node -> forward[0];
+            destroy_node(node);
+            node = next;
+        }
+    }
+    batch.clear();
+}
+
+
+/*
+* 将 key 不小于给定值的节点移到新表中返回。
+* 各层在 key 处切断，O(log n)；新表的元素个数需要沿第 0 层统计一遍。
+*/
+template<typename Key, typename Value, typename Traits>
+std::unique_ptr<Skiplist<Key, Value, Traits>> Skiplist<Key, Value, Traits>::split_at(const Key &key){
+
+    int interval = 5;
+    if constexpr (Traits::enable_background) {
+        interval = _compactor.interval_sec;
+    }
+    std::unique_ptr<Skiplist> other(new Skiplist(max_level(), interval));
+
+    std::unique_lock<std::shared_mutex> lock(rw_mtx);
+    std::unique_lock<std::shared_mutex> other_lock(other -> rw_mtx);
+
+    node_type *update[update_capacity];
+    find_greater_or_equal(key, update);
+
+    for(int i = 0; i <= _skip_list_level; ++ i){
+        other -> _header -> forward[i] = update[i] -> forward[i];
+        update[i] -> forward[i] = nullptr;
+    }
+    other -> _skip_list_level = _skip_list_level;
+    other -> shrink_level();
+    shrink_level();
+
+    int moved = 0;
+    for(node_type *node = other -> _header -> forward[0]; node != nullptr; node = node -> forward[0]){
+        ++ moved;
+        if constexpr (Traits::enable_eviction) {
+            if (node -> is_timed()) {
+                lru.remove_node(node);
+                other -> lru.adopt(node);
+            }
+        }
+    }
+    _element_count -= moved;
+    other -> _element_count = moved;
+
+    if (moved > 0) {
+        emit(OP_TRUNCATE, key, key);
+    }
+
+    return other;
+}
+
+
+/*
+* 将 other 的全部节点并入本表，other 变为空表。
+* 两表区间不相交时直接首尾相接，O(log n)；相交时沿 other 有序地逐个插入，
+* 查找从上一次插入的位置继续。本表已有的 key 保留原值，other 中的重复节点延迟释放。
+*/
+template<typename Key, typename Value, typename Traits>
+void Skiplist<Key, Value, Traits>::merge(Skiplist &other){
+
+    if (&other == this) {
+        return ;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(rw_mtx, std::defer_lock);
+    std::unique_lock<std::shared_mutex> other_lock(other.rw_mtx, std::defer_lock);
+    std::lock(lock, other_lock);
+
+    node_type *first = other._header -> forward[0];
+    if (first == nullptr) {
+        return ;
+    }
+
+    // 高于本表 max_level 的层直接丢弃
+    other.detach_levels_above(max_level());
+    int top = other._skip_list_level;
+
+    node_type *tails[update_capacity];
+    node_type *other_tails[update_capacity];
+    node_type *last = last_nodes(tails);
+    node_type *other_last = other.last_nodes(other_tails);
+    node_type *dups = nullptr;
+
+    bool append = last == _header || _compare(last -> get_key(), first -> get_key());
+    bool prepend = !append && _compare(other_last -> get_key(), _header -> forward[0] -> get_key());
+
+    // 不相交时定时节点整体转移到本表的 LRU
+    if constexpr (Traits::enable_eviction) {
+        if (append || prepend) {
+            for(node_type *node = first; node != nullptr; node = node -> forward[0]){
+                if (node -> is_timed()) {
+                    other.lru.remove_node(node);
+                    lru.adopt(node);
+                }
+            }
+        }
+    }
+
+    if (append || prepend) {
+        emit_chain(first);
+    }
+
+    if (append) {
+
+        // other 整体在本表之后
+        for(int i = 0; i <= top; ++ i){
+            tails[i] -> forward[i] = other._header -> forward[i];
+        }
+        _element_count += other._element_count;
+
+    } else if (prepend) {
+
+        // other 整体在本表之前
+        for(int i = 0; i <= top; ++ i){
+            if (other._header -> forward[i] != nullptr) {
+                other_tails[i] -> forward[i] = _header -> forward[i];
+                _header -> forward[i] = other._header -> forward[i];
+            }
+        }
+        _element_count += other._element_count;
+
+    } else {
+
+        node_type *update[update_capacity];
+        for(int i = 0; i <= max_level(); ++ i){
+            update[i] = _header;
+        }
+
+        node_type *node = first;
+        while (node != nullptr) {
+
+            node_type *next = node -> forward[0];
+            const Key &key = node -> get_key();
+
+            // 每层从上一层的结果和上一次的前驱中较靠后的一个继续查找
+            node_type *current = _header;
+            for(int i = _skip_list_level; i >= 0; -- i){
+                if (update[i] != _header && (current == _header || _compare(current -> get_key(), update[i] -> get_key()))) {
+                    current = update[i];
+                }
+                while(current -> forward[i] != nullptr && _compare(current -> forward[i] -> get_key(), key)){
+                    current = current -> forward[i];
+                }
+                update[i] = current;
+            }
+
+            node_type *succ = update[0] -> forward[0];
+            if (succ != nullptr && !_compare(key, succ -> get_key())) {
+
+                // 两边都有效时保留本表的节点；本表节点已删除或已过期时由 other 的节点替换
+                bool succ_dead = succ -> is_deleted() || succ -> is_timeout();
+                bool node_dead = node -> is_deleted() || node -> is_timeout();
+
+                if (!succ_dead || node_dead) {
+                    if constexpr (Traits::enable_eviction) {
+                        if (node -> is_timed()) {
+                            other.lru.remove_node(node);
+                        }
+                    }
+                    node -> forward[0] = dups;
+                    dups = node;
+                    node = next;
+                    continue;
+                }
+
+                for(int i = 0; i <= succ -> node_level; ++ i){
+                    update[i] -> forward[i] = succ -> forward[i];
+                }
+                if constexpr (Traits::enable_eviction) {
+                    if (succ -> is_timed()) {
+                        lru.remove_node(succ);
+                    }
+                }
+                -- _element_count;
+                succ -> forward[0] = dups;
+                dups = succ;
+            }
+
+            int level = node -> node_level < max_level() ? node -> node_level : max_level();
+            if (level > _skip_list_level) {
+                for(int i = _skip_list_level + 1; i <= level; ++ i){
+                    update[i] = _header;
+                }
+                _skip_list_level = level;
+            }
+            for(int i = 0; i <= level; ++ i){
+                node -> forward[i] = update[i] -> forward[i];
+                update[i] -> forward[i] = node;
+                update[i] = node;
+            }
+
+            if constexpr (Traits::enable_eviction) {
+                if (node -> is_timed()) {
+                    other.lru.remove_node(node);
+                    lru.adopt(node);
+                }
+            }
+            if (!node -> is_deleted()) {
+                emit(OP_INSERT, key, node -> get_value(), -1, node -> get_end_time());
+            }
+            ++ _element_count;
+            node = next;
+        }
+    }
+
+    if (top > _skip_list_level) {
+        _skip_list_level = top;
+    }
+
+    for(int i = 0; i <= other._skip_list_level; ++ i){
+        other._header -> forward[i] = nullptr;
+    }
+    other._skip_list_level = 0;
+    other._element_count = 0;
+    other.emit(OP_CLEAR, Key{}, Key{});
+
+    lock.unlock();
+    other_lock.unlock();
+    defer_free(dups);
+}
+
+
+/*
+* 删除 key 在 [lo, hi) 内的所有节点：各层一次切断，O(log n)。
+* 元素个数与 LRU 在写锁内沿摘下的链更新，节点延迟释放
+*/
+template<typename Key, typename Value, typename Traits>
+void Skiplist<Key, Value, Traits>::erase_range(const Key &lo, const Key &hi){
+
+    if (!_compare(lo, hi)) {
+        return ;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(rw_mtx);
+
+    node_type *update_lo[update_capacity];
+    node_type *update_hi[update_capacity];
+    node_type *head = find_greater_or_equal(lo, update_lo);
+    find_greater_or_equal(hi, update_hi);
+
+    // 区间内没有节点
+    if (update_hi[0] == update_lo[0]) {
+        return ;
+    }
+
+    node_type *tail = update_hi[0];
+    for(int i = 0; i <= _skip_list_level; ++ i){
+        if (update_hi[i] != update_lo[i]) {
+            update_lo[i] -> forward[i] = update_hi[i] -> forward[i];
+        }
+    }
+    tail -> forward[0] = nullptr;
+    shrink_level();
+
+    for(node_type *node = head; node != nullptr; node = node -> forward[0]){
+        if constexpr (Traits::enable_eviction) {
+            if (node -> is_timed()) {
+                lru.remove_node(node);
+            }
+        }
+        -- _element_count;
+    }
+    emit(OP_ERASE_RANGE, lo, hi);
+
+    lock.unlock();
+    defer_free(head);
+}
+
+
+
+
+template<typename Key, typename Value, typename Traits>
+void Skiplist<Key, Value, Traits>::set_change_listener(change_listener listener){
+
+    static_assert(Traits::enable_change_feed, "set_change_listener requires enable_change_feed");
+
+    std::unique_lock<std::shared_mutex> lock(rw_mtx);
+    _listener = std::move(listener);
+
+    if constexpr (Traits::enable_eviction) {
+        if (_listener) {
+            lru.set_expire_callback([this](node_type *node) {
+                emit(OP_EXPIRE, node -> get_key(), node -> get_key());
+            });
+        } else {
+            lru.set_expire_callback(nullptr);
+        }
+    }
+}
+
+
+template<typename Key, typename Value, typename Traits>
+template<typename Begin, typename F>
+void Skiplist<Key, Value, Traits>::snapshot(Begin begin, F f){
+
+    std::shared_lock<std::shared_mutex> lock(rw_mtx);
+
+    begin();
+    for(node_type *node = _header -> forward[0]; node != nullptr; node = node -> forward[0]){
+        if (!node -> is_deleted() && !node -> is_timeout()) {
+            if constexpr (std::is_invocable_v<F&, const Key&, const Value&, time_t>) {
+                f(node -> get_key(), node -> get_value(), node -> get_end_time());
+            } else {
+                f(node -> get_key(), node -> get_value());
+            }
+        }
+    }
+}
+
+
+template<typename Key, typename Value, typename Traits>
+template<typename F>
+void Skiplist<Key, Value, Traits>::scan(const Key &lo, const Key &hi, F f){
+
+    std::shared_lock<std::shared_mutex> lock(rw_mtx);
+
+    node_type *node = find_greater_or_equal(lo, nullptr);
+    for(; node != nullptr && _compare(node -> get_key(), hi); node = node -> forward[0]){
+        if (!node -> is_deleted() && !node -> is_timeout()) {
+            f(node -> get_key(), node -> get_value());
+        }
+    }
+}
+
+
+template<typename Key, typename Value, typename Traits>
+void Skiplist<Key, Value, Traits>::emit(ChangeOp op, const Key &key, const Value &val, int ttl, time_t deadline){
+    if constexpr (Traits::enable_change_feed) {
+        if (_listener) {
+            ChangeEvent<Key, Value> event{0, op, key, Key{}, val, ttl, deadline};
+            _listener(event);
+        }
+    }
+}
+
+
+template<typename Key, typename Value, typename Traits>
+void Skiplist<Key, Value, Traits>::emit(ChangeOp op, const Key &key, const Key &end_key){
+    if constexpr (Traits::enable_change_feed) {
+        if (_listener) {
+            ChangeEvent<Key, Value> event{0, op, key, end_key, Value{}, -1};
+            _listener(event);
+        }
+    }
+}
+
+
+// 为一条以空指针结尾的节点链逐个发出插入事件
+template<typename Key, typename Value, typename Traits>
+void Skiplist<Key, Value, Traits>::emit_chain(node_type *node){
+    if constexpr (Traits::enable_change_feed) {
+        if (!_listener) {
+            return ;
+        }
+        for(; node != nullptr; node = node -> forward[0]){
+            if (!node -> is_deleted()) {
+                emit(OP_INSERT, node -> get_key(), node -> get_value(), -1, node -> get_end_time());
+            }
+        }
+    }
+}
+
+
+/*
+* 按访问频率重新分配层数并重建第 1 层及以上的索引，O(n)，持有写锁。
+* 访问占比为 p 的 key 目标层数为 1 + log2(p * n)，不低于插入时的随机层数，
+* 使查找热点 key 的期望代价接近 log(1/p) 而不是 log n。
+* 每次调整后访问计数减半，不再被访问的 key 逐渐回落到原来的层数。
+*/
+template<typename Key, typename Value, typename Traits>
+void Skiplist<Key, Value, Traits>::rebalance_levels() {
+
+    static_assert(Traits::enable_adaptive_levels, "rebalance_levels requires enable_adaptive_levels");
+
+    std::unique_lock<std::shared_mutex> lock(rw_mtx);
+
+    unsigned long long total = _access_total.exchange(0, std::memory_order_relaxed);
+    // 上次调整后没有访问，保持当前层数
+    if (total == 0) {
+        return ;
+    }
+
+    node_type *last[update_capacity];
+    for(int i = 0; i <= max_level(); ++ i){
+        last[i] = _header;
+    }
+
+    unsigned long long carried = 0;
+    int top = 0;
+    for(node_type *node = _header -> forward[0]; node != nullptr; node = node -> forward[0]){
+
+        unsigned hits = node -> hits.load(std::memory_order_relaxed);
+        int target = node -> base_level;
+        if (hits > 0 && total > 0) {
+            double share = static_cast<double>(hits) * _element_count / total;
+            if (share >= 1.0) {
+                int biased = 1 + static_cast<int>(std::log2(share));
+                target = biased > target ? biased : target;
+            }
+        }
+        target = target < max_level() ? target : max_level();
+
+        if (target != node -> node_level) {
+            node_type **forward = forward_alloc_traits::allocate(_forward_alloc, target + 1);
+            memset(forward, 0, sizeof(node_type*) * (target + 1));
+            forward[0] = node -> forward[0];
+            forward_alloc_traits::deallocate(_forward_alloc, node -> forward, node -> node_level + 1);
+            node -> forward = forward;
+            node -> node_level = target;
+        }
+
+        for(int i = 1; i <= target; ++ i){
+            last[i] -> forward[i] = node;
+            last[i] = node;
+        }
+        top = target > top ? target : top;
+
+        // 计数衰减，剩余部分计入下一轮的总数
+        node -> hits.store(hits >> 1, std::memory_order_relaxed);
+        carried += hits >> 1;
+    }
+
+    for(int i = 1; i <= max_level(); ++ i){
+        last[i] -> forward[i] = nullptr;
+    }
+    _skip_list_level = top;
+    _access_total.fetch_add(carried, std::memory_order_relaxed);
+}
+
+
+template<typename Key, typename Value, typename Traits>
+int Skiplist<Key, Value, Traits>::size() const {
     return this -> _element_count;
 }
 
 
+template<typename Key, typename Value, typename Traits>
+const SkiplistStats &Skiplist<Key, Value, Traits>::stats() const {
+    static_assert(Traits::enable_stats, "stats() requires enable_stats");
+    return _stats;
+}
 
 
-template <typename Key, typename Value>
-void Skiplist<Key, Value>::display_list(){
+
+template <typename Key, typename Value, typename Traits>
+void Skiplist<Key, Value, Traits>::display_list(){
     
     for(int i = _skip_list_level; i >= 0; -- i){
-        Node<Key, Value>* current = this -> _header -> forward[i];
+        node_type* current = this -> _header -> forward[i];
         std::cout << "Level " << i << " ";
         while(current != nullptr){
-            if(current -> deleted == false) {
+            if(!current -> is_deleted()) {
                 std::cout << " " <<current -> get_key() << ":" << current -> get_value() << " ";
             }
             current = current -> forward[i];
@@ -635,9 +1806,8 @@ void Skiplist<Key, Value>::display_list(){
 
 
 
-
-template<typename Key, typename Value>
-bool Skiplist<Key, Value>::is_valid_string(const std::string& str){
+template<typename Key, typename Value, typename Traits>
+bool Skiplist<Key, Value, Traits>::is_valid_string(const std::string& str){
     
     if (str.empty()) {
         return false;
@@ -650,8 +1820,8 @@ bool Skiplist<Key, Value>::is_valid_string(const std::string& str){
 
 
 
-template<typename Key, typename Value>
-void Skiplist<Key, Value>::get_key_value_from_string(const std::string& str, std::string* key, std::string* val){
+template<typename Key, typename Value, typename Traits>
+void Skiplist<Key, Value, Traits>::get_key_value_from_string(const std::string& str, std::string* key, std::string* val){
     if (!is_valid_string(str)) {
         return ;
     }
@@ -663,13 +1833,13 @@ void Skiplist<Key, Value>::get_key_value_from_string(const std::string& str, std
 
 
 
-template <typename Key, typename Value>
-void Skiplist<Key, Value>::dump_file() {
+template <typename Key, typename Value, typename Traits>
+void Skiplist<Key, Value, Traits>::dump_file() {
     
 
     std::cout << "dump_file---------------\n";
     _file_writer.open(STORE_FILE);
-    Node<Key, Value> *node = this -> _header -> forward[0];
+    Node<Key, Value, Traits> *node = this -> _header -> forward[0];
 
     while (node != nullptr) {
 
@@ -686,8 +1856,8 @@ void Skiplist<Key, Value>::dump_file() {
 
 
 
-template<typename Key, typename Value>
-void Skiplist<Key, Value>::load_file() {
+template<typename Key, typename Value, typename Traits>
+void Skiplist<Key, Value, Traits>::load_file() {
 
     _file_reader.open(STORE_FILE);
     std::cout << "load_file-------------\n";
@@ -706,35 +1876,406 @@ void Skiplist<Key, Value>::load_file() {
 }
 
 
-template<typename Key, typename Value>
-void Skiplist<Key, Value>::start_compact_scheduler() {    
-    _compact_running.store(true);
-    _compact_thread = std::thread([this]() {
-        std::unique_lock<std::mutex> lk(_compact_mtx);
-        while (_compact_running.load()) {
-            // 等待期间释放锁，允许其他线程修改状态
-            if (_compact_cv.wait_for(lk, std::chrono::seconds(_compact_interval_sec)) == 
-                std::cv_status::timeout) {
+
+
+/*
+* 用于并行加载的层数生成，每个线程使用自己的随机数引擎
+*/
+template<typename Key, typename Value, typename Traits>
+int Skiplist<Key, Value, Traits>::random_level(std::minstd_rand &rng) const {
+    int k = 1;
+    while(rng() % 2 == 1){
+        ++ k;
+    }
+    k = (k < max_level()) ? k : max_level();
+    return k;
+}
+
+
+/*
+* 写出 [begin, end) 之间的未删除节点并 fdatasync，返回写出的条数，写入失败返回 -1
+*/
+template<typename Key, typename Value, typename Traits>
+int Skiplist<Key, Value, Traits>::dump_segment(const std::string &path, node_type *begin, node_type *end) {
+
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror("open segment");
+        return -1;
+    }
+
+    std::ostringstream out;
+    int count = 0;
+    bool ok = true;
+    for (node_type *node = begin; node != end && ok; node = node -> forward[0]) {
+        if (node -> is_deleted() || node -> is_timeout()) {
+            continue;
+        }
+        out << node -> get_key() << delimiter << node -> get_value() << "\n";
+        ++ count;
+        // 攒够 1MB 写一次
+        if (out.tellp() >= (1 << 20)) {
+            ok = snapshot_write_all(fd, out.str());
+            out.str("");
+        }
+    }
+
+    ok = ok && snapshot_write_all(fd, out.str());
+    if (ok && fdatasync(fd) != 0) {
+        perror("fdatasync segment");
+        ok = false;
+    }
+    close(fd);
+    return ok ? count : -1;
+}
+
+
+/*
+* 读取分段快照清单：segments:<段数>、generation:<代号>，之后每行一个 <段文件>:<条数>
+* 清单不存在或格式不符时返回 false
+*/
+template<typename Key, typename Value, typename Traits>
+bool Skiplist<Key, Value, Traits>::read_manifest(std::vector<std::string> *paths, std::vector<int> *counts, unsigned long long *generation) {
+
+    std::ifstream reader(STORE_FILE MANIFEST_SUFFIX);
+    if (!reader.is_open()) {
+        return false;
+    }
+
+    std::string line, name, field;
+    int segs = -1;
+    *generation = 0;
+    while (getline(reader, line)) {
+        if (!is_valid_string(line)) {
+            continue;
+        }
+        get_key_value_from_string(line, &name, &field);
+        if (name == "segments") {
+            parse_field(field, &segs);
+        } else if (name == "generation") {
+            parse_field(field, generation);
+        } else {
+            int count = -1;
+            parse_field(field, &count);
+            paths -> push_back(name);
+            counts -> push_back(count);
+        }
+    }
+    return segs >= 0 && segs == static_cast<int>(paths -> size());
+}
+
+
+/*
+* 并行快照：以高层索引节点为分界把 key 空间切成 parts 段，每段一个线程写入
+* STORE_FILE.seg<i>.<代号>，全部成功后再写清单 STORE_FILE.manifest（先写临时文件再 rename）。
+* 段文件与临时清单在 rename 之前 fdatasync，rename 前后各 fsync 一次目录，rename 是提交点。
+* 每次快照使用新的代号，旧清单引用的段文件在 rename 之前不会被改动，rename 落盘之后才删除。
+* 成功返回 0，失败返回 -1 且旧快照保持不变。
+*/
+template<typename Key, typename Value, typename Traits>
+int Skiplist<Key, Value, Traits>::dump_file_parallel(int parts) {
+
+    std::vector<std::string> old_paths;
+    std::vector<int> old_counts;
+    unsigned long long generation = 0;
+    read_manifest(&old_paths, &old_counts, &generation);
+    ++ generation;
+
+    std::shared_lock<std::shared_mutex> lock(rw_mtx);
+
+    if (parts < 1) {
+        parts = 1;
+    }
+
+    // 自顶向下找到第一个节点数不少于 parts 的层，作为分界点来源
+    std::vector<node_type*> splits;
+    for (int i = _skip_list_level; i >= 0; -- i) {
+        splits.clear();
+        for (node_type *node = _header -> forward[i]; node != nullptr; node = node -> forward[i]) {
+            splits.push_back(node);
+        }
+        if (static_cast<int>(splits.size()) >= parts) {
+            break;
+        }
+    }
+
+    // 均匀选出 parts 个段的起点
+    std::vector<node_type*> bounds;
+    if (splits.empty()) {
+        bounds.push_back(nullptr);
+    } else {
+        bounds.push_back(_header -> forward[0]);
+        int n = static_cast<int>(splits.size());
+        int segs = parts < n ? parts : n;
+        for (int k = 1; k < segs; ++ k) {
+            bounds.push_back(splits[static_cast<long long>(k) * n / segs]);
+        }
+    }
+    bounds.push_back(nullptr);
+
+    int segs = static_cast<int>(bounds.size()) - 1;
+    std::vector<int> counts(segs, 0);
+    std::vector<std::string> paths(segs);
+    std::vector<std::thread> workers;
+    for (int k = 0; k < segs; ++ k) {
+        paths[k] = STORE_FILE SEGMENT_SUFFIX + std::to_string(k) + "." + std::to_string(generation);
+        workers.emplace_back([this, k, &bounds, &counts, &paths]() {
+            counts[k] = dump_segment(paths[k], bounds[k], bounds[k + 1]);
+        });
+    }
+    for (std::thread &t : workers) {
+        t.join();
+    }
+    lock.unlock();
+
+    for (int k = 0; k < segs; ++ k) {
+        if (counts[k] < 0) {
+            std::cout << "dump_file_parallel: failed to write " << paths[k] << "\n";
+            for (const std::string &path : paths) {
+                std::remove(path.c_str());
+            }
+            return -1;
+        }
+    }
+
+    std::string manifest = STORE_FILE MANIFEST_SUFFIX;
+    std::ostringstream out;
+    out << "segments" << delimiter << segs << "\n";
+    out << "generation" << delimiter << generation << "\n";
+    for (int k = 0; k < segs; ++ k) {
+        out << paths[k] << delimiter << counts[k] << "\n";
+    }
+
+    bool ok = false;
+    int fd = open((manifest + ".tmp").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        ok = snapshot_write_all(fd, out.str());
+        if (ok && fdatasync(fd) != 0) {
+            perror("fdatasync manifest");
+            ok = false;
+        }
+        close(fd);
+    } else {
+        perror("open manifest");
+    }
+    // 段文件的目录项先落盘，清单才能引用它们
+    ok = ok && snapshot_sync_dir(manifest);
+    if (ok && std::rename((manifest + ".tmp").c_str(), manifest.c_str()) != 0) {
+        perror("rename manifest");
+        ok = false;
+    }
+    if (!ok) {
+        std::remove((manifest + ".tmp").c_str());
+        std::cout << "dump_file_parallel: failed to write " << manifest << "\n";
+        for (const std::string &path : paths) {
+            std::remove(path.c_str());
+        }
+        return -1;
+    }
+
+    // rename 落盘之前旧快照仍是恢复时的依据，不能删除
+    if (!snapshot_sync_dir(manifest)) {
+        return 0;
+    }
+    for (const std::string &path : old_paths) {
+        if (std::find(paths.begin(), paths.end(), path) == paths.end()) {
+            std::remove(path.c_str());
+        }
+    }
+    return 0;
+}
+
+
+/*
+* 解析一个段文件并构建各层的局部链表，段内 key 必须严格递增
+*/
+template<typename Key, typename Value, typename Traits>
+bool Skiplist<Key, Value, Traits>::load_segment(const std::string &path, Segment *seg) {
+
+    std::ifstream reader(path);
+    if (!reader.is_open()) {
+        return false;
+    }
+
+    std::minstd_rand rng(std::hash<std::string>()(path) ^ static_cast<unsigned>(time(nullptr)));
+    seg -> head.assign(max_level() + 1, nullptr);
+    seg -> tail.assign(max_level() + 1, nullptr);
+
+    std::string line, key_str, val_str;
+    Key key;
+    Value val;
+    while (getline(reader, line)) {
+        if (!is_valid_string(line)) {
+            continue;
+        }
+        get_key_value_from_string(line, &key_str, &val_str);
+        parse_field(key_str, &key);
+        parse_field(val_str, &val);
+
+        if (seg -> tail[0] != nullptr && !_compare(seg -> tail[0] -> get_key(), key)) {
+            seg -> ordered = false;
+        }
+
+        int level = random_level(rng);
+        node_type *node = create_node(key, val, level);
+        for (int i = 0; i <= level; ++ i) {
+            if (seg -> tail[i] == nullptr) {
+                seg -> head[i] = node;
+            } else {
+                seg -> tail[i] -> forward[i] = node;
+            }
+            seg -> tail[i] = node;
+        }
+        seg -> level = level > seg -> level ? level : seg -> level;
+        ++ seg -> count;
+    }
+    return true;
+}
+
+
+/*
+* 并行加载 dump_file_parallel 生成的快照：每个段一个线程解析并建好局部跳表，
+* 再在写锁下把各段首尾相接。当前表非空或段之间无序时，退回逐条 insert_element。
+* 清单缺失、任一段文件缺失或条数与清单不符时不修改当前表，返回 -1；成功返回加载的条数。
+* 节点在多个线程中分配，自定义分配器需要是线程安全的。
+*/
+template<typename Key, typename Value, typename Traits>
+int Skiplist<Key, Value, Traits>::load_file_parallel() {
+
+    std::vector<std::string> paths;
+    std::vector<int> counts;
+    unsigned long long generation = 0;
+    if (!read_manifest(&paths, &counts, &generation)) {
+        std::cout << "load_file_parallel: missing or malformed " << STORE_FILE MANIFEST_SUFFIX << "\n";
+        return -1;
+    }
+
+    std::vector<Segment> segs(paths.size());
+    std::vector<char> loaded(paths.size(), 0);
+    std::vector<std::thread> workers;
+    for (size_t k = 0; k < paths.size(); ++ k) {
+        workers.emplace_back([this, k, &paths, &segs, &loaded]() {
+            loaded[k] = load_segment(paths[k], &segs[k]);
+        });
+    }
+    for (std::thread &t : workers) {
+        t.join();
+    }
+
+    int total = 0;
+    bool complete = true;
+    for (size_t k = 0; k < paths.size(); ++ k) {
+        if (!loaded[k] || segs[k].count != counts[k]) {
+            std::cout << "load_file_parallel: segment " << paths[k] << (loaded[k] ? " has " : " is missing, ")
+                      << segs[k].count << " of " << counts[k] << " entries\n";
+            complete = false;
+        }
+        total += segs[k].count;
+    }
+    if (!complete) {
+        for (Segment &seg : segs) {
+            node_type *node = seg.count ? seg.head[0] : nullptr;
+            while (node != nullptr) {
+                node_type *next = node -> forward[0];
+                destroy_node(node);
+                node = next;
+            }
+        }
+        return -1;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(rw_mtx);
+
+    bool stitchable = _header -> forward[0] == nullptr;
+    node_type *last = nullptr;
+    for (Segment &seg : segs) {
+        if (seg.count == 0) {
+            continue;
+        }
+        if (!seg.ordered || (last != nullptr && !_compare(last -> get_key(), seg.head[0] -> get_key()))) {
+            stitchable = false;
+        }
+        last = seg.tail[0];
+    }
+
+    if (!stitchable) {
+        lock.unlock();
+        for (Segment &seg : segs) {
+            node_type *node = seg.count ? seg.head[0] : nullptr;
+            while (node != nullptr) {
+                node_type *next = node -> forward[0];
+                insert_element(node -> get_key(), node -> get_value());
+                destroy_node(node);
+                node = next;
+            }
+        }
+        return total;
+    }
+
+    std::vector<node_type*> tail(max_level() + 1, _header);
+    for (Segment &seg : segs) {
+        if (seg.count == 0) {
+            continue;
+        }
+        emit_chain(seg.head[0]);
+        for (int i = 0; i <= seg.level; ++ i) {
+            if (seg.head[i] != nullptr) {
+                tail[i] -> forward[i] = seg.head[i];
+                tail[i] = seg.tail[i];
+            }
+        }
+        _skip_list_level = seg.level > _skip_list_level ? seg.level : _skip_list_level;
+        _element_count += seg.count;
+    }
+    return total;
+}
+
+
+template<typename Key, typename Value, typename Traits>
+void Skiplist<Key, Value, Traits>::start_compact_scheduler() {    
+    _compactor.running.store(true);
+    _compactor.thread = std::thread([this]() {
+        std::unique_lock<std::mutex> lk(_compactor.mtx);
+        std::vector<node_type*> batch;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(_compactor.interval_sec);
+        while (_compactor.running.load()) {
+            // 等待期间释放锁，允许其他线程修改状态；被 defer_free 唤醒时不推迟下一次 compact
+            if (_compactor.cv.wait_until(lk, deadline) == std::cv_status::timeout) {
                 lk.unlock(); // 释放锁后再执行compact
                 compact();   // 假设compact不依赖当前锁保护的数据
+                if constexpr (Traits::enable_adaptive_levels) {
+                    rebalance_levels();
+                }
                 lk.lock();   // 重新加锁以继续循环或等待
+                deadline = std::chrono::steady_clock::now() + std::chrono::seconds(_compactor.interval_sec);
+            }
+            if (!_compactor.garbage.empty()) {
+                batch.swap(_compactor.garbage);
+                lk.unlock();
+                reclaim(batch);
+                lk.lock();
             }
         }
     });
 }
 
 
-template<typename Key, typename Value>
-void Skiplist<Key, Value>::stop_compact_scheduler() {
+template<typename Key, typename Value, typename Traits>
+void Skiplist<Key, Value, Traits>::stop_compact_scheduler() {
 
-    std::cout << "stop compact" << std::endl;
-    {
-        std::lock_guard<std::mutex> lk(_compact_mtx);
-        _compact_running.store(false);  // Mark the thread as stopping
-    }
-    _compact_cv.notify_all();     // 唤醒可能正在等待的线程
-    if (_compact_thread.joinable()) {
-        _compact_thread.join();
+    if constexpr (Traits::enable_background) {
+        std::cout << "stop compact" << std::endl;
+        {
+            std::lock_guard<std::mutex> lk(_compactor.mtx);
+            _compactor.running.store(false);  // Mark the thread as stopping
+        }
+        _compactor.cv.notify_all();     // 唤醒可能正在等待的线程
+        if (_compactor.thread.joinable()) {
+            _compactor.thread.join();
+        }
     }
 
-}
\ No newline at end of file
+}
+
+
+#endif
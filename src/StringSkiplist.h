@@ -0,0 +1,537 @@
+#ifndef STRING_SKIPLIST_H
+#define STRING_SKIPLIST_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/*
+* 字符串 key 专用跳表
+*
+* key 的字节存放在连续的 key arena 中，节点只保存指针和长度；
+* 节点缓存 key 的前 8 字节（大端打包为整数），遍历时先比较整数，相同时才比较完整 key。
+* 开启前缀压缩后，新 key 与第 0 层前驱共享的前缀不再重复存储，
+* 节点记录 base（一段完整 key 的字节）和共享长度，只把剩余后缀写入 arena。
+* 删除不立即回收 arena 字节，已删除的字节超过存活字节时按顺序重新编码所有 key，整体换新 arena。
+*/
+
+#define STRING_ARENA_BLOCK (64 * 1024)   // arena 块大小
+#define STRING_MIN_SHARED 4              // 共享前缀不足该长度时不压缩
+#define STRING_MAX_LEVEL 63              // 层数上限，决定 update 数组大小
+
+
+/*
+* 只追加的字节 arena，已分配的字节地址不变，clear() 或整体替换时释放
+*/
+class KeyArena {
+
+private:
+
+    std::vector<std::unique_ptr<char[]>> _blocks;
+    char *_cur{nullptr};
+    size_t _left{0};
+    size_t _bytes{0};
+
+public:
+
+    const char *append(const char *data, size_t len) {
+        if (len > _left) {
+            // 大 key 单独占一块，不浪费当前块的剩余空间
+            size_t block = len > STRING_ARENA_BLOCK / 4 ? len : STRING_ARENA_BLOCK;
+            _blocks.emplace_back(new char[block]);
+            if (block == len) {
+                memcpy(_blocks.back().get(), data, len);
+                _bytes += len;
+                return _blocks.back().get();
+            }
+            _cur = _blocks.back().get();
+            _left = block;
+        }
+        char *p = _cur;
+        memcpy(p, data, len);
+        _cur += len;
+        _left -= len;
+        _bytes += len;
+        return p;
+    }
+
+    void clear() {
+        _blocks.clear();
+        _cur = nullptr;
+        _left = 0;
+        _bytes = 0;
+    }
+
+    size_t bytes() const {
+        return _bytes;
+    }
+
+    void swap(KeyArena &other) {
+        _blocks.swap(other._blocks);
+        std::swap(_cur, other._cur);
+        std::swap(_left, other._left);
+        std::swap(_bytes, other._bytes);
+    }
+};
+
+
+
+template<typename Value>
+struct StringNode {
+
+    uint64_t prefix;       // key 前 8 字节，不足补 0
+    const char *base;      // 共享前缀所在的完整 key，未压缩时为空
+    const char *suffix;    // arena 中的剩余部分，未压缩时即完整 key
+    uint32_t shared;       // 与 base 共享的前缀长度
+    uint32_t suffix_len;
+    Value val;
+
+    int node_level;
+    StringNode<Value> **forward;
+
+    StringNode(const Value &v, int level) : prefix(0), base(nullptr), suffix(nullptr), shared(0), suffix_len(0), val(v), node_level(level) {
+        forward = new StringNode<Value> *[level + 1];
+        memset(forward, 0, sizeof(StringNode<Value>*) * (level + 1));
+    }
+
+    ~StringNode() {
+        delete[] forward;
+    }
+
+    size_t key_size() const {
+        return shared + suffix_len;
+    }
+
+    std::string get_key() const {
+        std::string key;
+        key.reserve(key_size());
+        key.append(base ? base : "", shared);
+        key.append(suffix, suffix_len);
+        return key;
+    }
+};
+
+
+
+template<typename Value>
+class StringSkiplist {
+
+    typedef StringNode<Value> Node;
+
+    // 一次操作中查找 key 及其预先计算的前缀
+    struct Probe {
+        std::string_view key;
+        uint64_t prefix;
+    };
+
+private:
+
+    int _max_level;
+    int _skip_list_level;
+    Node *_header;
+    int _element_count;
+    bool _compress;
+    size_t _dead_bytes;          // 已删除节点在 arena 中的字节数
+
+    KeyArena _arena;
+    std::shared_mutex rw_mtx;
+
+public:
+
+    StringSkiplist(int);
+    StringSkiplist(int, bool);
+    ~StringSkiplist();
+
+    int get_random_level();
+    int insert_element(std::string_view, const Value&);
+    bool search_element(std::string_view);
+    bool search_element(std::string_view, Value*);
+    void delete_element(std::string_view);
+    int edit_element(std::string_view, const Value&);
+    std::vector<std::pair<std::string, Value>> prefix_scan(std::string_view);
+    void display_list();
+    void clear();
+    int size() const;
+    size_t arena_bytes() const;
+    void compact_arena();
+
+private:
+
+    static uint64_t load_prefix(std::string_view);
+    static Probe make_probe(std::string_view);
+    static int compare_key(const Node*, const Probe&);
+    static bool has_prefix(const Node*, std::string_view);
+    static size_t common_prefix(const Node*, std::string_view);
+
+    Node *find_greater_or_equal(const Probe&, Node**);
+    void set_key(Node*, std::string_view, Node*, KeyArena&);
+    void rebuild_arena();
+
+};
+
+
+template<typename Value>
+StringSkiplist<Value>::StringSkiplist(int max_level) : StringSkiplist(max_level, true) {}
+
+template<typename Value>
+StringSkiplist<Value>::StringSkiplist(int max_level, bool compress) :
+    _max_level(max_level < STRING_MAX_LEVEL ? max_level : STRING_MAX_LEVEL),
+    _skip_list_level(0),
+    _element_count(0),
+    _compress(compress),
+    _dead_bytes(0) {
+
+    _header = new Node(Value{}, _max_level);
+}
+
+
+template<typename Value>
+StringSkiplist<Value>::~StringSkiplist() {
+    clear();
+    delete _header;
+}
+
+
+template<typename Value>
+uint64_t StringSkiplist<Value>::load_prefix(std::string_view key) {
+    // 大端打包，整数大小关系与前 8 字节的字典序一致
+    uint64_t p = 0;
+    for (size_t i = 0; i < 8; ++ i) {
+        p = (p << 8) | (i < key.size() ? static_cast<unsigned char>(key[i]) : 0);
+    }
+    return p;
+}
+
+
+template<typename Value>
+typename StringSkiplist<Value>::Probe StringSkiplist<Value>::make_probe(std::string_view key) {
+    return Probe{key, load_prefix(key)};
+}
+
+
+/*
+* 比较节点 key 与 probe，小于返回负数，等于返回 0，大于返回正数
+*/
+template<typename Value>
+int StringSkiplist<Value>::compare_key(const Node *node, const Probe &probe) {
+
+    if (node -> prefix != probe.prefix) {
+        return node -> prefix < probe.prefix ? -1 : 1;
+    }
+
+    std::string_view key = probe.key;
+    size_t n = node -> shared < key.size() ? node -> shared : key.size();
+    int r = n ? memcmp(node -> base, key.data(), n) : 0;
+    if (r != 0 || n < node -> shared) {
+        return r != 0 ? r : 1;
+    }
+
+    key.remove_prefix(n);
+    n = node -> suffix_len < key.size() ? node -> suffix_len : key.size();
+    r = n ? memcmp(node -> suffix, key.data(), n) : 0;
+    if (r != 0) {
+        return r;
+    }
+    if (node -> suffix_len == key.size()) {
+        return 0;
+    }
+    return node -> suffix_len < key.size() ? -1 : 1;
+}
+
+
+template<typename Value>
+bool StringSkiplist<Value>::has_prefix(const Node *node, std::string_view prefix) {
+    return node -> key_size() >= prefix.size() && common_prefix(node, prefix) == prefix.size();
+}
+
+
+template<typename Value>
+size_t StringSkiplist<Value>::common_prefix(const Node *node, std::string_view key) {
+
+    size_t i = 0;
+    for (; i < node -> shared && i < key.size(); ++ i) {
+        if (node -> base[i] != key[i]) {
+            return i;
+        }
+    }
+    if (i < node -> shared) {
+        return i;
+    }
+    for (size_t j = 0; j < node -> suffix_len && i < key.size(); ++ j, ++ i) {
+        if (node -> suffix[j] != key[i]) {
+            return i;
+        }
+    }
+    return i;
+}
+
+
+/*
+* 写入节点 key，pred 为第 0 层前驱，开启压缩时与其共享前缀
+*/
+template<typename Value>
+void StringSkiplist<Value>::set_key(Node *node, std::string_view key, Node *pred, KeyArena &arena) {
+
+    node -> prefix = load_prefix(key);
+
+    if (_compress && pred != _header) {
+        // base 始终指向一段连续的完整 key，避免形成引用链
+        const char *base = pred -> shared ? pred -> base : pred -> suffix;
+        size_t limit = pred -> shared ? pred -> shared : pred -> suffix_len;
+        size_t shared = common_prefix(pred, key);
+        shared = shared < limit ? shared : limit;
+
+        if (shared >= STRING_MIN_SHARED) {
+            node -> base = base;
+            node -> shared = shared;
+            node -> suffix = arena.append(key.data() + shared, key.size() - shared);
+            node -> suffix_len = key.size() - shared;
+            return ;
+        }
+    }
+
+    node -> base = nullptr;
+    node -> shared = 0;
+    node -> suffix = arena.append(key.data(), key.size());
+    node -> suffix_len = key.size();
+}
+
+
+
+template<typename Value>
+int StringSkiplist<Value>::get_random_level() {
+    int k = 1;
+    while (rand() % 2 == 1) {
+        ++ k;
+    }
+    k = (k < _max_level) ? k : _max_level;
+    return k;
+}
+
+
+template<typename Value>
+StringNode<Value> *StringSkiplist<Value>::find_greater_or_equal(const Probe &probe, Node **update) {
+
+    Node *current = _header;
+    for (int i = _skip_list_level; i >= 0; -- i) {
+        while (current -> forward[i] != nullptr && compare_key(current -> forward[i], probe) < 0) {
+            current = current -> forward[i];
+        }
+        if (update) {
+            update[i] = current;
+        }
+    }
+    return current -> forward[0];
+}
+
+
+template<typename Value>
+int StringSkiplist<Value>::insert_element(std::string_view key, const Value &val) {
+
+    std::unique_lock<std::shared_mutex> lock(rw_mtx);
+
+    Probe probe = make_probe(key);
+    Node *update[STRING_MAX_LEVEL + 1];
+    Node *current = find_greater_or_equal(probe, update);
+
+    if (current != nullptr && compare_key(current, probe) == 0) {
+        std::cout << "Key: " << key << ", exists. \n";
+        return 1;
+    }
+
+    int random_level = get_random_level();
+    if (random_level > _skip_list_level) {
+        for (int i = _skip_list_level + 1; i <= random_level; ++ i) {
+            update[i] = _header;
+        }
+        _skip_list_level = random_level;
+    }
+
+    Node *node = new Node(val, random_level);
+    set_key(node, key, update[0], _arena);
+    for (int i = 0; i <= random_level; ++ i) {
+        node -> forward[i] = update[i] -> forward[i];
+        update[i] -> forward[i] = node;
+    }
+
+    ++ _element_count;
+    return 0;
+}
+
+
+template<typename Value>
+bool StringSkiplist<Value>::search_element(std::string_view key) {
+    return search_element(key, nullptr);
+}
+
+
+template<typename Value>
+bool StringSkiplist<Value>::search_element(std::string_view key, Value *val) {
+
+    std::shared_lock<std::shared_mutex> lock(rw_mtx);
+
+    Probe probe = make_probe(key);
+    Node *current = find_greater_or_equal(probe, nullptr);
+    if (current == nullptr || compare_key(current, probe) != 0) {
+        return false;
+    }
+    if (val) {
+        *val = current -> val;
+    }
+    return true;
+}
+
+
+/*
+* 立即摘除并释放节点，key 字节留在 arena 中（其他节点可能以它为 base），
+* 累计的已删除字节超过存活字节时重建 arena
+*/
+template<typename Value>
+void StringSkiplist<Value>::delete_element(std::string_view key) {
+
+    std::unique_lock<std::shared_mutex> lock(rw_mtx);
+
+    Probe probe = make_probe(key);
+    Node *update[STRING_MAX_LEVEL + 1];
+    Node *current = find_greater_or_equal(probe, update);
+
+    if (current == nullptr || compare_key(current, probe) != 0) {
+        return ;
+    }
+
+    for (int i = 0; i <= current -> node_level; ++ i) {
+        update[i] -> forward[i] = current -> forward[i];
+    }
+    _dead_bytes += current -> suffix_len;
+    delete current;
+    -- _element_count;
+
+    while (_skip_list_level > 0 && _header -> forward[_skip_list_level] == nullptr) {
+        -- _skip_list_level;
+    }
+
+    if (_dead_bytes > STRING_ARENA_BLOCK && _dead_bytes * 2 > _arena.bytes()) {
+        rebuild_arena();
+    }
+}
+
+
+template<typename Value>
+int StringSkiplist<Value>::edit_element(std::string_view key, const Value &val) {
+
+    std::unique_lock<std::shared_mutex> lock(rw_mtx);
+
+    Probe probe = make_probe(key);
+    Node *current = find_greater_or_equal(probe, nullptr);
+    if (current == nullptr || compare_key(current, probe) != 0) {
+        return 0;
+    }
+    current -> val = val;
+    return 1;
+}
+
+
+/*
+* 返回所有以 prefix 开头的 key 及其值，按 key 有序
+*/
+template<typename Value>
+std::vector<std::pair<std::string, Value>> StringSkiplist<Value>::prefix_scan(std::string_view prefix) {
+
+    std::shared_lock<std::shared_mutex> lock(rw_mtx);
+
+    std::vector<std::pair<std::string, Value>> result;
+    Node *current = find_greater_or_equal(make_probe(prefix), nullptr);
+    while (current != nullptr && has_prefix(current, prefix)) {
+        result.emplace_back(current -> get_key(), current -> val);
+        current = current -> forward[0];
+    }
+    return result;
+}
+
+
+template<typename Value>
+void StringSkiplist<Value>::clear() {
+
+    std::unique_lock<std::shared_mutex> lock(rw_mtx);
+
+    Node *current = _header -> forward[0];
+    while (current) {
+        Node *tmp = current -> forward[0];
+        delete current;
+        current = tmp;
+    }
+    for (int i = 0; i <= _skip_list_level; ++ i) {
+        _header -> forward[i] = nullptr;
+    }
+    _skip_list_level = 0;
+    _element_count = 0;
+    _dead_bytes = 0;
+    _arena.clear();
+}
+
+
+template<typename Value>
+void StringSkiplist<Value>::compact_arena() {
+    std::unique_lock<std::shared_mutex> lock(rw_mtx);
+    rebuild_arena();
+}
+
+
+/*
+* 按第 0 层顺序把每个 key 重新写入新 arena，前驱先完成编码，
+* 后继的 base 因此只会指向新 arena；旧 arena 在全部节点改写后释放
+*/
+template<typename Value>
+void StringSkiplist<Value>::rebuild_arena() {
+
+    KeyArena fresh;
+    std::string key;
+    Node *pred = _header;
+    for (Node *node = _header -> forward[0]; node != nullptr; node = node -> forward[0]) {
+        key = node -> get_key();
+        set_key(node, key, pred, fresh);
+        pred = node;
+    }
+
+    _arena.swap(fresh);
+    _dead_bytes = 0;
+}
+
+
+template<typename Value>
+int StringSkiplist<Value>::size() const {
+    return _element_count;
+}
+
+
+template<typename Value>
+size_t StringSkiplist<Value>::arena_bytes() const {
+    return _arena.bytes();
+}
+
+
+template<typename Value>
+void StringSkiplist<Value>::display_list() {
+
+    std::shared_lock<std::shared_mutex> lock(rw_mtx);
+
+    for (int i = _skip_list_level; i >= 0; -- i) {
+        Node *current = _header -> forward[i];
+        std::cout << "Level " << i << " ";
+        while (current != nullptr) {
+            std::cout << " " << current -> get_key() << ":" << current -> val << " ";
+            current = current -> forward[i];
+        }
+        std::cout << "\n";
+    }
+}
+
+#endif
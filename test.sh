@@ -1,4 +1,21 @@
 # 生成可执行文件
-g++ test/stress_test.cpp -o ./bin/stress  --std=c++11 -pthread  
+mkdir -p bin store
+g++ test/stress_test.cpp -o ./bin/stress  --std=c++17 -pthread  
+g++ test/replication_bench.cpp -o ./bin/replication_bench --std=c++17 -pthread
+g++ test/replication_test.cpp -o ./bin/replication_test --std=c++17 -pthread
+g++ test/adaptive_bench.cpp -o ./bin/adaptive_bench --std=c++17 -pthread -O2
+g++ test/skiplist_test.cpp -o ./bin/skiplist_test --std=c++17 -pthread
+g++ test/string_skiplist_test.cpp -o ./bin/string_skiplist_test --std=c++17 -pthread
+g++ test/mmap_test.cpp -o ./bin/mmap_test --std=c++17 -pthread
+g++ test/async_test.cpp -o ./bin/async_test --std=c++20 -pthread
+g++ test/async_bench.cpp -o ./bin/async_bench --std=c++20 -pthread
 # 执行
-./bin/stress
\ No newline at end of file
+./bin/skiplist_test
+./bin/mmap_test
+./bin/replication_test
+./bin/string_skiplist_test
+./bin/async_test
+./bin/stress
+./bin/replication_bench
+./bin/adaptive_bench
+./bin/async_bench
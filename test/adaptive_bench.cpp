@@ -0,0 +1,89 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include "../src/Skiplist.h"
+
+#define KEY_COUNT 1000000
+#define LOOKUP_COUNT 2000000
+#define MAX_LEVEL 20
+#define ROUNDS 3
+
+struct StaticTraits : DefaultSkiplistTraits {
+    static constexpr bool enable_background = false;
+};
+
+struct AdaptiveTraits : DefaultSkiplistTraits {
+    static constexpr bool enable_background = false;
+    static constexpr bool enable_adaptive_levels = true;
+};
+
+// Zipf(1) 分布的查找序列，排名打乱后映射到 key，热点分散在整个表中
+std::vector<int> zipf_keys(std::mt19937 &rng) {
+    std::vector<double> cdf(KEY_COUNT);
+    double sum = 0;
+    for (int i = 0; i < KEY_COUNT; ++ i) {
+        sum += 1.0 / (i + 1);
+        cdf[i] = sum;
+    }
+    std::vector<int> rank_to_key(KEY_COUNT);
+    for (int i = 0; i < KEY_COUNT; ++ i) {
+        rank_to_key[i] = i;
+    }
+    std::shuffle(rank_to_key.begin(), rank_to_key.end(), rng);
+
+    std::uniform_real_distribution<double> uniform(0, sum);
+    std::vector<int> keys(LOOKUP_COUNT);
+    for (int i = 0; i < LOOKUP_COUNT; ++ i) {
+        size_t rank = std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin();
+        keys[i] = rank_to_key[rank < KEY_COUNT ? rank : KEY_COUNT - 1];
+    }
+    return keys;
+}
+
+template<typename Traits>
+double run(const std::vector<int> &keys, const char *name) {
+
+    Skiplist<int, int, Traits> list(MAX_LEVEL);
+    for (int i = 0; i < KEY_COUNT; ++ i) {
+        list.insert_element(i, i);
+    }
+
+    // 预热一轮，自适应模式据此调整层数
+    for (int key : keys) {
+        list.search_element(key);
+    }
+    if constexpr (Traits::enable_adaptive_levels) {
+        list.rebalance_levels();
+    }
+
+    // 取多轮中的最短耗时，减少机器负载带来的抖动
+    double best = 0;
+    int found = 0;
+    for (int round = 0; round < ROUNDS; ++ round) {
+        auto start = std::chrono::high_resolution_clock::now();
+        found = 0;
+        for (int key : keys) {
+            found += list.search_element(key);
+        }
+        auto finish = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> elapsed = finish - start;
+        best = (round == 0 || elapsed.count() < best) ? elapsed.count() : best;
+    }
+
+    std::cout << name << " lookups:" << LOOKUP_COUNT << " found:" << found
+              << " best elapsed:" << best << std::endl;
+    return best;
+}
+
+int main() {
+
+    std::mt19937 rng(42);
+    std::vector<int> keys = zipf_keys(rng);
+
+    double base = run<StaticTraits>(keys, "static  ");
+    double adaptive = run<AdaptiveTraits>(keys, "adaptive");
+    std::cout << "speedup:" << base / adaptive << std::endl;
+    return 0;
+}
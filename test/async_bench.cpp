@@ -0,0 +1,87 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <time.h>
+#include "../src/AsyncSkiplist.h"
+
+#define NUM_THREADS 4
+#define EXECUTOR_THREADS 4
+#define TEST_COUNT 200000
+#define DURABLE_COUNT 2000
+#define LOG_FILE "store/async.log"
+#define SNAPSHOT_FILE "store/async.snapshot"
+
+SkiplistExecutor executor(EXECUTOR_THREADS);
+Skiplist<int, std::string> skip_list(18);
+AsyncSkiplist<int, std::string> async_list(skip_list, executor);
+
+std::atomic<int> failed{0};
+
+AsyncTask<int> putElement(int count) {
+    int bad = 0;
+    for (int i = 0; i < count; ++ i) {
+        if (co_await async_list.async_put(rand() % TEST_COUNT, "test") < 0) {
+            ++ bad;
+        }
+    }
+    co_return bad;
+}
+
+AsyncTask<int> getElement(int count) {
+    int hits = 0;
+    for (int i = 0; i < count; ++ i) {
+        if (co_await async_list.async_get(rand() % TEST_COUNT)) {
+            ++ hits;
+        }
+    }
+    co_return hits;
+}
+
+// 每个线程相当于一个事件循环，阻塞等待自己的协程
+template<typename F>
+double run_clients(F f) {
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < NUM_THREADS; i++) {
+        threads.emplace_back([&f, i]() { failed += sync_wait(f(i)); });
+    }
+    for (std::thread &t : threads) {
+        t.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count();
+}
+
+int main() {
+
+    srand (time(NULL));
+
+    std::cout << "io_uring:" << async_list.using_io_uring() << std::endl;
+
+    double elapsed = run_clients([](int) { return putElement(TEST_COUNT / NUM_THREADS); });
+    std::cout << "async_put elapsed:" << elapsed << " ops/s:" << TEST_COUNT / elapsed << std::endl;
+
+    elapsed = run_clients([](int) { return getElement(TEST_COUNT / NUM_THREADS); });
+    std::cout << "async_get elapsed:" << elapsed << " ops/s:" << TEST_COUNT / elapsed << std::endl;
+
+    // 持久写：每次 async_put 都等待日志 fdatasync
+    failed = 0;
+    unlink(LOG_FILE);
+    if (!async_list.open_log(LOG_FILE)) {
+        return 1;
+    }
+    elapsed = run_clients([](int) { return putElement(DURABLE_COUNT / NUM_THREADS); });
+    std::cout << "durable async_put elapsed:" << elapsed << " ops/s:" << DURABLE_COUNT / elapsed
+              << " failed:" << failed.load() << std::endl;
+    async_list.close_log();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    long bytes = sync_wait(async_list.async_snapshot(SNAPSHOT_FILE));
+    std::chrono::duration<double> snapshot_elapsed = std::chrono::high_resolution_clock::now() - start;
+    std::cout << "async_snapshot elapsed:" << snapshot_elapsed.count() << " bytes:" << bytes
+              << " size:" << skip_list.size() << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include <iostream>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../src/AsyncSkiplist.h"
+
+#define TEST_COUNT 200
+#define LOG_FILE "store/async_test.log"
+
+int failed = 0;
+
+void check(bool cond, const char *name) {
+    std::cout << (cond ? "PASS " : "FAIL ") << name << std::endl;
+    if (!cond) {
+        ++ failed;
+    }
+}
+
+typedef AsyncSkiplist<int, std::string> AsyncList;
+
+AsyncTask<int> put_all(AsyncList &list, int count) {
+    int bad = 0;
+    for (int i = 0; i < count; ++ i) {
+        if (co_await list.async_put(i, "v" + std::to_string(i)) < 0) {
+            ++ bad;
+        }
+    }
+    co_return bad;
+}
+
+// 写入 TEST_COUNT 条持久记录后返回日志内容
+std::string write_log(SkiplistExecutor &executor) {
+    unlink(LOG_FILE);
+    Skiplist<int, std::string> list(18);
+    AsyncList async_list(list, executor);
+    async_list.open_log(LOG_FILE);
+    check(sync_wait(put_all(async_list, TEST_COUNT)) == 0, "durable puts succeed");
+    async_list.close_log();
+
+    std::ifstream reader(LOG_FILE, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(reader)), std::istreambuf_iterator<char>());
+}
+
+void write_file(const std::string &data) {
+    std::ofstream writer(LOG_FILE, std::ios::binary | std::ios::trunc);
+    writer.write(data.data(), data.size());
+}
+
+int replay(SkiplistExecutor &executor, Skiplist<int, std::string> &list) {
+    AsyncList async_list(list, executor);
+    return async_list.replay_log(LOG_FILE);
+}
+
+// 校验重放结果：[0, count) 之外的 key 均不存在，值均完整
+bool replayed(Skiplist<int, std::string> &list, int count, int skip) {
+    std::string val;
+    for (int i = 0; i < TEST_COUNT; ++ i) {
+        bool found = list.search_element(i, &val);
+        if (i == skip || i >= count) {
+            if (found) {
+                return false;
+            }
+        } else if (!found || val != "v" + std::to_string(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 日志记录插入时的过期时刻，重放时跳过已经过期的 key
+void test_ttl_replay(SkiplistExecutor &executor) {
+    unlink(LOG_FILE);
+    {
+        Skiplist<int, std::string> list(18);
+        AsyncList async_list(list, executor);
+        async_list.open_log(LOG_FILE);
+        sync_wait(async_list.async_put(1, "short", 1));
+        sync_wait(async_list.async_put(2, "forever"));
+        sync_wait(async_list.async_put(3, "long", 60));
+        async_list.close_log();
+    }
+    sleep(3);
+
+    Skiplist<int, std::string> list(18);
+    std::string val;
+    check(replay(executor, list) == 2 && !list.search_element(1) &&
+          list.search_element(2, &val) && val == "forever" &&
+          list.search_element(3, &val) && val == "long", "replay skips expired puts");
+}
+
+// 删除也写入日志，重放后 key 不再出现
+void test_delete_replay(SkiplistExecutor &executor) {
+    unlink(LOG_FILE);
+    {
+        Skiplist<int, std::string> list(18);
+        AsyncList async_list(list, executor);
+        async_list.open_log(LOG_FILE);
+        sync_wait(async_list.async_put(1, "a"));
+        sync_wait(async_list.async_put(2, "b"));
+        check(sync_wait(async_list.async_delete(1)) == 0, "durable delete succeeds");
+        async_list.close_log();
+    }
+
+    Skiplist<int, std::string> list(18);
+    check(replay(executor, list) == 3 && !list.search_element(1) && list.search_element(2), "replay deletes");
+}
+
+int main() {
+
+    SkiplistExecutor executor(2);
+    std::string log = write_log(executor);
+    uint32_t first_len;
+    memcpy(&first_len, log.data() + 4, 4);
+    size_t record = ASYNC_LOG_HEADER + first_len;  // 第一条记录的长度
+    size_t last = log.rfind(std::string("\x57\x41\x4c\x52", 4));
+
+    {
+        Skiplist<int, std::string> list(18);
+        check(replay(executor, list) == TEST_COUNT && replayed(list, TEST_COUNT, -1), "replay full log");
+    }
+
+    // 最后一条记录被截断，不能以缩短的值重放
+    {
+        write_file(log.substr(0, log.size() - 1));
+        Skiplist<int, std::string> list(18);
+        check(replay(executor, list) == TEST_COUNT - 1 && replayed(list, TEST_COUNT - 1, -1), "skip torn trailing record");
+    }
+
+    // 中间预留但未写入的区域留下 '\0' 空洞
+    {
+        std::string holed = log;
+        for (size_t i = 0; i < record; ++ i) {
+            holed[i] = '\0';
+        }
+        write_file(holed);
+        Skiplist<int, std::string> list(18);
+        check(replay(executor, list) == TEST_COUNT - 1 && replayed(list, TEST_COUNT, 0), "skip zero hole");
+    }
+
+    // 负载被改写，校验和不通过
+    {
+        std::string corrupt = log;
+        corrupt[last + ASYNC_LOG_HEADER] ^= 1;
+        write_file(corrupt);
+        Skiplist<int, std::string> list(18);
+        check(replay(executor, list) == TEST_COUNT - 1 && replayed(list, TEST_COUNT - 1, -1), "skip corrupt record");
+    }
+
+    test_ttl_replay(executor);
+    test_delete_replay(executor);
+
+    unlink(LOG_FILE);
+    return failed ? 1 : 0;
+}
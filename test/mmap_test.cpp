@@ -0,0 +1,155 @@
+#include <iostream>
+#include <cstddef>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "../src/MmapSkiplist.h"
+
+#define TEST_FILE "store/mmap_test.mmap"
+#define TEST_COUNT 5000
+
+int failed = 0;
+
+void check(bool ok, const char *what) {
+    std::cout << (ok ? "PASS " : "FAIL ") << what << std::endl;
+    if (!ok) {
+        ++ failed;
+    }
+}
+
+// 正常关闭后重新打开，数据与删除标记都应保留
+void test_reopen() {
+    unlink(TEST_FILE);
+    {
+        MmapSkiplist<int, int> list(TEST_FILE, 16);
+        for (int i = 0; i < TEST_COUNT; ++ i) {
+            list.insert_element(i, i * 2);
+        }
+        list.delete_element(7);
+    }
+    MmapSkiplist<int, int> list(TEST_FILE, 16);
+    bool ok = !list.recovered() && list.size() == TEST_COUNT && !list.search_element(7);
+    for (int i = 0, val; i < TEST_COUNT && ok; ++ i) {
+        ok = i == 7 || (list.search_element(i, &val) && val == i * 2);
+    }
+    check(ok, "reopen after clean close");
+}
+
+// 子进程写入后不经析构直接退出，模拟崩溃，重新打开时执行恢复
+void test_crash_recovery() {
+    unlink(TEST_FILE);
+    pid_t pid = fork();
+    if (pid == 0) {
+        MmapSkiplist<int, int> *list = new MmapSkiplist<int, int>(TEST_FILE, 16);
+        for (int i = 0; i < TEST_COUNT; ++ i) {
+            list -> insert_element(i, i + 1);
+        }
+        list -> delete_element(3);
+        list -> compact();
+        _exit(0);
+    }
+    waitpid(pid, nullptr, 0);
+
+    MmapSkiplist<int, int> list(TEST_FILE, 16);
+    bool ok = list.recovered() && list.size() == TEST_COUNT - 1 && !list.search_element(3);
+    for (int i = 0, val; i < TEST_COUNT && ok; ++ i) {
+        ok = i == 3 || (list.search_element(i, &val) && val == i + 1);
+    }
+    check(ok, "recover after crash");
+
+    // 恢复后重建的上层索引可以继续写入
+    for (int i = TEST_COUNT; i < TEST_COUNT * 2; ++ i) {
+        list.insert_element(i, i + 1);
+    }
+    ok = list.size() == TEST_COUNT * 2 - 1;
+    for (int i = TEST_COUNT, val; i < TEST_COUNT * 2 && ok; ++ i) {
+        ok = list.search_element(i, &val) && val == i + 1;
+    }
+    check(ok, "insert after recovery");
+}
+
+// 过期节点回收后被复用，上层不能残留指向它们的偏移
+void test_compact_expired() {
+    unlink(TEST_FILE);
+    MmapSkiplist<int, int> list(TEST_FILE, 16, false);
+    for (int i = 0; i < TEST_COUNT; ++ i) {
+        list.insert_element(i * 2, i, 1);
+        list.insert_element(i * 2 + 1, i);
+    }
+    sleep(2);
+    list.compact();
+    bool ok = list.size() == TEST_COUNT;
+
+    for (int i = 0; i < TEST_COUNT; ++ i) {
+        list.insert_element(TEST_COUNT * 2 + i, i);
+    }
+    for (int i = 0, val; i < TEST_COUNT && ok; ++ i) {
+        ok = !list.search_element(i * 2) &&
+             list.search_element(i * 2 + 1, &val) && val == i &&
+             list.search_element(TEST_COUNT * 2 + i, &val) && val == i;
+    }
+    check(ok && list.size() == TEST_COUNT * 2, "compact expired nodes and reuse them");
+}
+
+// 改写头部的一个字段，模拟损坏或来源不明的文件
+template<typename T>
+void patch_header(size_t offset, T value) {
+    int fd = open(TEST_FILE, O_WRONLY);
+    if (pwrite(fd, &value, sizeof(value), offset) != sizeof(value)) {
+        perror("pwrite");
+    }
+    uint32_t dirty = 0;
+    if (pwrite(fd, &dirty, sizeof(dirty), offsetof(MmapFileHeader, clean)) != sizeof(dirty)) {
+        perror("pwrite");
+    }
+    close(fd);
+}
+
+// 头部层数或偏移越界时拒绝打开，而不是在恢复时越界访问
+void test_corrupt_header() {
+    unlink(TEST_FILE);
+    {
+        MmapSkiplist<int, int> list(TEST_FILE, 16);
+        for (int i = 0; i < 100; ++ i) {
+            list.insert_element(i, i);
+        }
+    }
+    patch_header<uint32_t>(offsetof(MmapFileHeader, max_level), 1000);
+    {
+        MmapSkiplist<int, int> list(TEST_FILE, 16);
+        check(!list.is_open(), "reject max_level above MMAP_MAX_LEVEL");
+    }
+
+    unlink(TEST_FILE);
+    {
+        MmapSkiplist<int, int> list(TEST_FILE, 16);
+        list.insert_element(1, 1);
+    }
+    patch_header<uint64_t>(offsetof(MmapFileHeader, header_node), 1ULL << 40);
+    {
+        MmapSkiplist<int, int> list(TEST_FILE, 16);
+        check(!list.is_open(), "reject header_node past end of file");
+    }
+
+    unlink(TEST_FILE);
+    {
+        MmapSkiplist<int, int> list(TEST_FILE, 16);
+        list.insert_element(1, 1);
+    }
+    patch_header<uint64_t>(offsetof(MmapFileHeader, arena_top), 1ULL << 40);
+    {
+        MmapSkiplist<int, int> list(TEST_FILE, 16);
+        check(!list.is_open(), "reject arena_top past end of file");
+    }
+}
+
+int main() {
+
+    test_reopen();
+    test_crash_recovery();
+    test_compact_expired();
+    test_corrupt_header();
+    unlink(TEST_FILE);
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,94 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <time.h>
+#include "../src/Replication.h"
+
+#define NUM_THREADS 3
+#define TEST_COUNT 300000
+#define PRELOAD_COUNT 100000
+#define SOCKET_PATH "/tmp/skiplist_replication.sock"
+
+Skiplist<int, std::string> leader_list(18, 60);
+Skiplist<int, std::string> follower_list(18, 60);
+
+std::atomic<bool> writing{true};
+
+void insertElement(int tid) {
+    int tmp = TEST_COUNT / NUM_THREADS;
+    for (int i = tid * tmp, count = 0; count < tmp; ++ i) {
+        ++ count;
+        leader_list.insert_element(i, "test");
+    }
+}
+
+int main() {
+
+    srand (time(NULL));
+
+    ReplicationLeader<int, std::string> leader(leader_list, SOCKET_PATH);
+    if (!leader.start()) {
+        return 1;
+    }
+
+    // 先写入一部分数据，follower 需要从快照加日志尾部追上
+    for (int i = 0; i < PRELOAD_COUNT; ++ i) {
+        leader_list.insert_element(-1 - i, "preload");
+    }
+
+    ReplicationFollower<int, std::string> follower(follower_list, SOCKET_PATH);
+    if (!follower.start()) {
+        return 1;
+    }
+
+    // 采样 follower 的延迟（落后的事件数）
+    unsigned long long max_lag = 0, sum_lag = 0, samples = 0;
+    std::thread sampler([&]() {
+        while (writing.load()) {
+            unsigned long long lag = leader.head_seq() - follower.applied_seq();
+            max_lag = lag > max_lag ? lag : max_lag;
+            sum_lag += lag;
+            ++ samples;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < NUM_THREADS; i++) {
+        threads.emplace_back(insertElement, i);
+    }
+    for (std::thread &t : threads) {
+        t.join();
+    }
+
+    auto written = std::chrono::high_resolution_clock::now();
+    writing.store(false);
+    sampler.join();
+
+    unsigned long long head = leader.head_seq();
+    while (follower.applied_seq() < head) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    auto finish = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double> write_elapsed = written - start;
+    std::chrono::duration<double> replicate_elapsed = finish - start;
+    std::chrono::duration<double> drain_elapsed = finish - written;
+
+    std::cout << "leader insert elapsed:" << write_elapsed.count()
+              << " ops/s:" << TEST_COUNT / write_elapsed.count() << std::endl;
+    std::cout << "follower apply elapsed:" << replicate_elapsed.count()
+              << " events/s:" << follower.applied_events() / replicate_elapsed.count() << std::endl;
+    std::cout << "lag max:" << max_lag << " avg:" << (samples ? sum_lag / samples : 0)
+              << " drain after writes:" << drain_elapsed.count() << std::endl;
+    std::cout << "leader size:" << leader_list.size() << " follower size:" << follower_list.size() << std::endl;
+
+    follower.stop();
+    leader.stop();
+    return 0;
+}
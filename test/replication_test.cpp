@@ -0,0 +1,162 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// 调小日志上限，使停滞的 follower 很快触发重新同步
+#define REPL_MAX_LOG_EVENTS 1000
+#include "../src/Replication.h"
+
+#define TEST_COUNT 50000
+#define SOCKET_PATH "/tmp/skiplist_replication_test.sock"
+
+int failed = 0;
+
+void check(bool cond, const char *name) {
+    std::cout << (cond ? "PASS " : "FAIL ") << name << std::endl;
+    if (!cond) {
+        ++ failed;
+    }
+}
+
+// 只连接不读取的 follower，模拟停滞的副本
+int connect_raw() {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, SOCKET_PATH, sizeof(addr.sun_path) - 1);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        perror("connect");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// 读取帧直到收到第 want 个快照结束帧，返回收到的快照开始帧数
+int drain_snapshots(int fd, int want) {
+    std::string buf;
+    char tmp[65536];
+    int begins = 0, ends = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (ends < want && std::chrono::steady_clock::now() < deadline) {
+        ssize_t n = recv(fd, tmp, sizeof(tmp), 0);
+        if (n <= 0) {
+            break;
+        }
+        buf.append(tmp, n);
+        size_t pos = 0;
+        while (buf.size() - pos >= 5) {
+            uint32_t len;
+            memcpy(&len, buf.data() + pos, 4);
+            if (buf.size() - pos < 5 + static_cast<size_t>(len)) {
+                break;
+            }
+            unsigned char type = buf[pos + 4];
+            begins += type == FRAME_SNAPSHOT_BEGIN;
+            ends += type == FRAME_SNAPSHOT_END;
+            pos += 5 + len;
+        }
+        buf.erase(0, pos);
+    }
+    return begins;
+}
+
+// 停滞的 follower 不能让 leader 的日志无限增长
+void test_stalled_follower() {
+
+    Skiplist<int, std::string> leader_list(18, 60);
+    Skiplist<int, std::string> follower_list(18, 60);
+
+    ReplicationLeader<int, std::string> leader(leader_list, SOCKET_PATH);
+    ReplicationFollower<int, std::string> follower(follower_list, SOCKET_PATH);
+    int stalled = -1;
+    if (!leader.start() || !follower.start() || (stalled = connect_raw()) < 0) {
+        check(false, "start leader and followers");
+        return ;
+    }
+    while (leader.follower_count() < 2) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    for (int i = 0; i < TEST_COUNT; ++ i) {
+        leader_list.insert_element(i, std::to_string(i));
+    }
+    check(leader.log_size() <= REPL_MAX_LOG_EVENTS, "log bounded while a follower stalls");
+    check(leader.resyncs() > 0, "stalled follower dropped from the log");
+
+    // 正常的 follower 不受停滞副本影响，最终与 leader 一致
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (follower.applied_seq() < leader.head_seq() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    bool same = follower_list.size() == leader_list.size();
+    std::string val;
+    for (int i = 0; same && i < TEST_COUNT; i += 997) {
+        same = follower_list.search_element(i, &val) && val == std::to_string(i);
+    }
+    check(same, "live follower matches leader");
+
+    // 停滞的副本恢复读取后收到新的快照
+    check(drain_snapshots(stalled, 2) >= 2, "stalled follower resyncs from a snapshot");
+    close(stalled);
+
+    follower.stop();
+    leader.stop();
+}
+
+// 等待 follower 应用到 leader 当前的序号
+template<typename Leader, typename Follower>
+void wait_applied(Leader &leader, Follower &follower) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (follower.applied_seq() < leader.head_seq() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+// 快照条目和插入事件都带过期时刻，即使 leader 没有发出 OP_EXPIRE，follower 也不再返回过期的 key
+void test_ttl() {
+
+    Skiplist<int, std::string> leader_list(18, 60);
+    Skiplist<int, std::string> follower_list(18, 60);
+
+    leader_list.insert_element(1, "snapshot", 1);
+    leader_list.insert_element(2, "forever");
+
+    ReplicationLeader<int, std::string> leader(leader_list, SOCKET_PATH);
+    ReplicationFollower<int, std::string> follower(follower_list, SOCKET_PATH);
+    if (!leader.start() || !follower.start()) {
+        check(false, "start leader and follower");
+        return ;
+    }
+    while (!follower.caught_up()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    leader_list.insert_element(3, "event", 1);
+    wait_applied(leader, follower);
+
+    std::string val;
+    check(follower_list.search_element(1, &val) && val == "snapshot" &&
+          follower_list.search_element(3, &val) && val == "event", "follower sees live timed keys");
+
+    sleep(3);
+    check(!follower_list.search_element(1) && !follower_list.search_element(3) &&
+          follower_list.search_element(2), "follower hides expired keys before OP_EXPIRE");
+
+    follower.stop();
+    leader.stop();
+}
+
+int main() {
+
+    test_stalled_follower();
+    test_ttl();
+
+    return failed ? 1 : 0;
+}
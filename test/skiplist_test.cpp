@@ -0,0 +1,256 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <time.h>
+#include <unistd.h>
+#include "../src/Skiplist.h"
+
+int failed = 0;
+
+void check(bool ok, const char *what) {
+    std::cout << (ok ? "PASS " : "FAIL ") << what << std::endl;
+    if (!ok) {
+        ++ failed;
+    }
+}
+
+// 没有 LRU 时由 compact() 回收过期节点
+struct ExpireTraits : DefaultSkiplistTraits {
+    static constexpr bool enable_eviction = false;
+    static constexpr bool enable_background = false;
+};
+
+// 节点在 compact() 执行期间到期，不能在上层残留后在第 0 层被释放
+void test_compact_expiring() {
+    Skiplist<int, int, ExpireTraits> list(18);
+    for (int i = 0; i < 100000; ++ i) {
+        list.insert_element(i, i, 1 + i % 3);
+    }
+    time_t end = time(nullptr) + 4;
+    while (time(nullptr) < end) {
+        list.compact();
+        for (int i = 0; i < 100000; i += 97) {
+            list.search_element(i);
+        }
+    }
+    list.compact();
+    check(list.size() == 0, "compact while nodes expire");
+}
+
+// 没有 LRU 时 compact() 回收过期节点也要发出 OP_EXPIRE，否则 follower 永远保留这些 key
+void test_compact_emits_expire() {
+    Skiplist<int, int, ExpireTraits> list(18);
+    std::vector<int> expired;
+    list.set_change_listener([&expired](ChangeEvent<int, int> &e) {
+        if (e.op == OP_EXPIRE) {
+            expired.push_back(e.key);
+        }
+    });
+    list.insert_element(1, 1, 1);
+    list.insert_element(2, 2);
+    list.insert_element(3, 3, 1);
+    list.delete_element(3);
+    sleep(2);
+    list.compact();
+    check(expired.size() == 1 && expired[0] == 1 && list.size() == 1, "compact emits OP_EXPIRE for expired nodes");
+}
+
+// 不启动后台线程，测试中由调用方决定何时 compact
+struct ManualTraits : DefaultSkiplistTraits {
+    static constexpr bool enable_background = false;
+};
+
+// 清单中的段文件路径
+std::vector<std::string> manifest_segments() {
+    std::vector<std::string> paths;
+    std::ifstream reader(STORE_FILE MANIFEST_SUFFIX);
+    std::string line;
+    while (getline(reader, line)) {
+        if (line.compare(0, 8, "segments") != 0 && line.compare(0, 10, "generation") != 0) {
+            paths.push_back(line.substr(0, line.find(delimiter)));
+        }
+    }
+    return paths;
+}
+
+bool same_contents(Skiplist<int, std::string, ManualTraits> &list, int count, int skip) {
+    std::string val;
+    bool ok = list.size() == count - 1;
+    for (int i = 0; i < count && ok; ++ i) {
+        ok = i == skip ? !list.search_element(i) : (list.search_element(i, &val) && val == "v" + std::to_string(i));
+    }
+    return ok;
+}
+
+void test_parallel_snapshot() {
+    const int count = 2000;
+    Skiplist<int, std::string, ManualTraits> list(18);
+    for (int i = 0; i < count; ++ i) {
+        list.insert_element(i, "v" + std::to_string(i));
+    }
+    list.delete_element(10);
+
+    check(list.dump_file_parallel(4) == 0, "dump_file_parallel succeeds");
+    std::vector<std::string> first = manifest_segments();
+    {
+        Skiplist<int, std::string, ManualTraits> loaded(18);
+        check(loaded.load_file_parallel() == count - 1 && same_contents(loaded, count, 10), "load_file_parallel round trip");
+    }
+
+    // 新快照使用新的段文件，提交后删除旧段文件
+    check(list.dump_file_parallel(4) == 0, "second dump_file_parallel succeeds");
+    std::vector<std::string> second = manifest_segments();
+    bool ok = !first.empty() && !second.empty();
+    for (const std::string &path : first) {
+        ok = ok && std::find(second.begin(), second.end(), path) == second.end() && access(path.c_str(), F_OK) != 0;
+    }
+    check(ok, "each dump writes a new generation and drops the old one");
+
+    // 段文件条数与清单不符
+    {
+        std::ofstream writer(second[0], std::ios::trunc);
+        writer << "0" << delimiter << "v0\n";
+    }
+    {
+        Skiplist<int, std::string, ManualTraits> loaded(18);
+        check(loaded.load_file_parallel() == -1 && loaded.size() == 0, "load fails on a short segment");
+    }
+
+    // 段文件缺失
+    list.dump_file_parallel(4);
+    std::remove(manifest_segments().back().c_str());
+    {
+        Skiplist<int, std::string, ManualTraits> loaded(18);
+        check(loaded.load_file_parallel() == -1 && loaded.size() == 0, "load fails on a missing segment");
+    }
+
+    for (const std::string &path : manifest_segments()) {
+        std::remove(path.c_str());
+    }
+    std::remove(STORE_FILE MANIFEST_SUFFIX);
+}
+
+typedef Skiplist<int, std::string, ManualTraits> TestList;
+
+// [lo, hi) 内每隔 step 一个 key，值为 tag + key
+void fill(TestList &list, int lo, int hi, int step, const std::string &tag) {
+    for (int i = lo; i < hi; i += step) {
+        list.insert_element(i, tag + std::to_string(i));
+    }
+}
+
+bool has(TestList &list, int key, const std::string &val) {
+    std::string got;
+    return list.search_element(key, &got) && got == val;
+}
+
+void test_split_merge() {
+
+    TestList a(18);
+    fill(a, 0, 1000, 1, "a");
+    std::unique_ptr<TestList> b = a.split_at(500);
+    bool ok = a.size() == 500 && b -> size() == 500 && has(a, 499, "a499") && !a.search_element(500) &&
+              has(*b, 500, "a500") && !b -> search_element(499);
+    check(ok, "split_at moves keys >= pivot");
+
+    a.merge(*b);
+    ok = a.size() == 1000 && b -> size() == 0 && has(a, 500, "a500") && has(a, 999, "a999");
+    check(ok, "merge appends a disjoint list");
+
+    TestList c(18);
+    fill(c, -100, 0, 1, "c");
+    a.merge(c);
+    ok = a.size() == 1100 && c.size() == 0 && has(a, -100, "c-100") && has(a, 0, "a0");
+    check(ok, "merge prepends a disjoint list");
+
+    // 交错的 key：本表有效节点优先，本表的墓碑被 other 的有效节点替换，other 的墓碑不复活
+    TestList d(18), e(18);
+    fill(d, 0, 100, 2, "d");
+    fill(e, 0, 100, 1, "e");
+    d.delete_element(4);
+    e.delete_element(51);
+    d.merge(e);
+    ok = has(d, 6, "d6") && has(d, 4, "e4") && has(d, 7, "e7") && !d.search_element(51) && e.size() == 0;
+    check(ok, "merge overlap keeps live, replaces tombstones");
+    d.compact();
+    check(d.size() == 99, "size after overlapping merge and compact");
+
+    TestList f(18);
+    fill(f, 0, 1000, 1, "f");
+    f.erase_range(100, 200);
+    ok = f.size() == 900 && has(f, 99, "f99") && !f.search_element(100) && !f.search_element(199) && has(f, 200, "f200");
+    check(ok, "erase_range removes [lo, hi)");
+    f.erase_range(-10, 10000);
+    check(f.size() == 0 && !f.search_element(500), "erase_range over the whole list");
+}
+
+// 合并后定时节点由本表的 LRU 负责过期，other 销毁后不再引用这些节点
+void test_merge_lru_handoff() {
+
+    TestList a(18);
+    fill(a, 0, 40, 2, "a");
+    {
+        TestList disjoint(18), overlap(18);
+        for (int i = 100; i < 110; ++ i) {
+            disjoint.insert_element(i, "t", 1);
+        }
+        for (int i = 1; i < 40; i += 2) {
+            overlap.insert_element(i, "t", 1);
+        }
+        a.merge(disjoint);
+        a.merge(overlap);
+    }
+    bool ok = a.size() == 50 && has(a, 101, "t") && has(a, 1, "t");
+    check(ok, "merge moves timed nodes");
+
+    sleep(2);
+    // 查找定时节点时触发 LRU 清理，之后过期节点不可见
+    a.search_element(101);
+    ok = !a.search_element(101) && !a.search_element(1) && has(a, 0, "a0");
+    a.compact();
+    check(ok && a.size() == 20, "merged timed nodes expire through this list's LRU");
+}
+
+// 默认配置由后台线程释放节点：size() 与 LRU 在 erase_range 返回时就已更新
+void test_erase_range_background() {
+
+    Skiplist<int, std::string> list(18);
+    std::vector<int> expired;
+    list.set_change_listener([&expired](ChangeEvent<int, std::string> &e) {
+        if (e.op == OP_EXPIRE) {
+            expired.push_back(e.key);
+        }
+    });
+    for (int i = 0; i < 1000; ++ i) {
+        list.insert_element(i, "v");
+    }
+    for (int i = 1000; i < 1100; ++ i) {
+        list.insert_element(i, "t", 1);
+    }
+
+    list.erase_range(100, 200);
+    list.erase_range(1000, 1050);
+    check(list.size() == 1000 - 100 + 50, "erase_range size with background freeing");
+
+    sleep(2);
+    // 查找定时节点触发 LRU 清理，被区间删除的 key 不应再产生过期事件
+    list.search_element(1060);
+    bool ok = !expired.empty();
+    for (int key : expired) {
+        ok = ok && key >= 1050;
+    }
+    check(ok, "erase_range removes timed nodes from the LRU");
+}
+
+int main() {
+
+    test_compact_expiring();
+    test_compact_emits_expire();
+    test_parallel_snapshot();
+    test_split_merge();
+    test_merge_lru_handoff();
+    test_erase_range_background();
+
+    return failed ? 1 : 0;
+}
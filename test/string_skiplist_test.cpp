@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "../src/StringSkiplist.h"
+
+#define TEST_COUNT 20000
+
+int failed = 0;
+
+typedef std::pair<std::string, int> Entry;
+
+bool same(const Entry &a, const std::pair<const std::string, int> &b) {
+    return a.first == b.first && a.second == b.second;
+}
+
+void check(bool ok, const char *what) {
+    std::cout << (ok ? "PASS " : "FAIL ") << what << std::endl;
+    if (!ok) {
+        ++ failed;
+    }
+}
+
+// 带公共前缀、长度不一、含 0 字节与高位字节的 key，覆盖前 8 字节相同时的完整比较
+std::string make_key(int i) {
+    std::string key = "user/" + std::to_string(i % 97) + "/";
+    if (i % 5 == 0) {
+        key.push_back('\0');
+    }
+    if (i % 7 == 0) {
+        key.push_back((char)0xe4);
+    }
+    key += std::to_string(i);
+    return key;
+}
+
+// 与 std::map 对比有序性、查找与前缀扫描
+void test_against_map(bool compress) {
+    StringSkiplist<int> list(18, compress);
+    std::map<std::string, int> expect;
+    for (int i = 0; i < TEST_COUNT; ++ i) {
+        int k = rand() % (TEST_COUNT * 2);
+        if (expect.emplace(make_key(k), k).second) {
+            list.insert_element(make_key(k), k);
+        }
+    }
+    for (int i = 0; i < TEST_COUNT / 4; ++ i) {
+        int k = rand() % (TEST_COUNT * 2);
+        list.delete_element(make_key(k));
+        expect.erase(make_key(k));
+    }
+
+    bool ok = list.size() == (int)expect.size();
+    for (int i = 0, val; i < TEST_COUNT * 2 && ok; ++ i) {
+        auto it = expect.find(make_key(i));
+        bool found = list.search_element(make_key(i), &val);
+        ok = found == (it != expect.end()) && (!found || val == it -> second);
+    }
+    check(ok, compress ? "search matches std::map (compressed)" : "search matches std::map (plain)");
+
+    // 空前缀返回全部 key，可用来检查整体顺序
+    std::vector<Entry> all = list.prefix_scan("");
+    ok = all.size() == expect.size() && std::equal(all.begin(), all.end(), expect.begin(), same);
+    check(ok, "full scan is in std::map order");
+
+    ok = true;
+    for (int p = 0; p < 97 && ok; ++ p) {
+        std::string prefix = "user/" + std::to_string(p) + "/";
+        std::vector<Entry> got = list.prefix_scan(prefix);
+        auto it = expect.lower_bound(prefix);
+        for (auto &kv : got) {
+            ok = ok && it != expect.end() && same(kv, *it);
+            ++ it;
+        }
+        ok = ok && (it == expect.end() || it -> first.compare(0, prefix.size(), prefix) != 0);
+    }
+    check(ok, "prefix_scan matches std::map range");
+}
+
+// 前缀压缩后 arena 占用应明显小于不压缩
+void test_compression() {
+    StringSkiplist<int> plain(18, false);
+    StringSkiplist<int> packed(18, true);
+    for (int i = 0; i < TEST_COUNT; ++ i) {
+        std::string key = "tenant/0001/orders/" + std::to_string(1000000 + i);
+        plain.insert_element(key, i);
+        packed.insert_element(key, i);
+    }
+    std::cout << "arena bytes plain:" << plain.arena_bytes() << " compressed:" << packed.arena_bytes() << std::endl;
+    check(packed.arena_bytes() * 2 < plain.arena_bytes(), "prefix compression shrinks arena");
+}
+
+// 反复删除与重新插入时 arena 不能无限增长
+void test_arena_reclaim() {
+    StringSkiplist<int> list(18, true);
+    for (int i = 0; i < TEST_COUNT; ++ i) {
+        list.insert_element(make_key(i), i);
+    }
+    size_t initial = list.arena_bytes();
+    for (int round = 0; round < 20; ++ round) {
+        for (int i = 0; i < TEST_COUNT; i += 2) {
+            list.delete_element(make_key(i));
+        }
+        for (int i = 0; i < TEST_COUNT; i += 2) {
+            list.insert_element(make_key(i), i);
+        }
+    }
+    bool ok = list.size() == TEST_COUNT && list.arena_bytes() < initial * 3;
+    for (int i = 0, val; i < TEST_COUNT && ok; ++ i) {
+        ok = list.search_element(make_key(i), &val) && val == i;
+    }
+    check(ok, "arena is reclaimed under delete/re-insert");
+
+    list.compact_arena();
+    ok = list.arena_bytes() <= initial;
+    for (int i = 0, val; i < TEST_COUNT && ok; ++ i) {
+        ok = list.search_element(make_key(i), &val) && val == i;
+    }
+    check(ok, "compact_arena keeps every key");
+}
+
+int main() {
+
+    srand(1);
+    test_against_map(true);
+    test_against_map(false);
+    test_compression();
+    test_arena_reclaim();
+
+    return failed ? 1 : 0;
+}